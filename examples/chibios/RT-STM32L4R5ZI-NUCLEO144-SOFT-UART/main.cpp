@@ -137,9 +137,6 @@ int main(void)
       }
       chprintf((BaseSequentialStream *) &LPSD1,"\r\n");
 
-      // waiting for sending
-      while(my_soft_uart.is_tx_full()) { /* nothing */ }
-
       // sending back from from soft_uart to SD3
       chprintf(
         (BaseSequentialStream *) &LPSD1,
@@ -147,7 +144,12 @@ int main(void)
         chVTGetSystemTime(),
         data
       );
-      my_soft_uart.set_tx_data(data);
+      // NOTE: the thread sleeps while the TX buffer is full
+      chnPutTimeout(
+        my_soft_uart.get_channel(),
+        static_cast<uint8_t>(data),
+        TIME_INFINITE
+      );
 
       // waiting for something
       msg_t sd_data;
@@ -0,0 +1,102 @@
+/**
+ ** soft_uart library
+ ** Copyright (C) 2015-2020
+ **
+ **   Antonio C. Domínguez Brito <antonio.dominguez@ulpgc.es>
+ **     División de Robótica y Oceanografía Computacional <www.roc.siani.es>
+ **     and Departamento de Informática y Sistemas <www.dis.ulpgc.es>
+ **     Universidad de Las Palmas de Gran  Canaria (ULPGC) <www.ulpgc.es>
+ **  
+ ** This file is part of the soft_uart library.
+ ** The soft_uart library is free software: you can redistribute it and/or modify
+ ** it under  the  terms of  the GNU  General  Public  License  as  published  by
+ ** the  Free Software Foundation, either  version  3  of  the  License,  or  any
+ ** later version.
+ ** 
+ ** The  soft_uart library is distributed in the hope that  it  will  be  useful,
+ ** but   WITHOUT   ANY WARRANTY;   without   even   the  implied   warranty   of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR  PURPOSE.  See  the  GNU  General
+ ** Public License for more details.
+ ** 
+ ** You should have received a copy  (COPYING file) of  the  GNU  General  Public
+ ** License along with the soft_uart library.
+ ** If not, see: <http://www.gnu.org/licenses/>.
+ **/
+/*
+ * File: fifo_benchmark.ino 
+ * Description: This is a benchmark of the fifos used by the soft_uart 
+ * library, measuring with the DWT cycle counter of the Cortex-M3 the 
+ * average number of CPU cycles taken by a push and a pop, for a length 
+ * which is a power of two (indexing with a mask), and for one which is 
+ * not (indexing with a modulo operation).
+ * Date: October 17th, 2026
+ * Author: Antonio C. Dominguez-Brito <antonio.dominguez@ulpgc.es>
+ * ROC-SIANI - Universidad de Las Palmas de Gran Canaria - Spain
+ */
+
+#include "soft_uart.h"
+
+#define ITERATIONS 10000
+
+volatile uint32_t sink;
+
+template<typename FIFO>
+__attribute__((noinline)) void benchmark(const char* name,FIFO& the_fifo)
+{
+  uint32_t data;
+  uint32_t push_cycles=0;
+  uint32_t pop_cycles=0;
+
+  for(uint32_t i=0; i<ITERATIONS; i++)
+  {
+    uint32_t start=DWT->CYCCNT;
+    the_fifo.push(i);
+    uint32_t middle=DWT->CYCCNT;
+    the_fifo.pop(data);
+    uint32_t end=DWT->CYCCNT;
+
+    push_cycles+=middle-start; pop_cycles+=end-middle;
+    sink=data;
+  }
+
+  Serial.print(name); 
+  Serial.print(": push "); Serial.print(double(push_cycles)/ITERATIONS);
+  Serial.print(" cycles, pop "); Serial.print(double(pop_cycles)/ITERATIONS);
+  Serial.println(" cycles");
+}
+
+fifo<uint32_t,100> fifo_100;
+fifo<uint32_t,128> fifo_128;
+circular_fifo<uint32_t,100> circular_fifo_100;
+circular_fifo<uint32_t,128> circular_fifo_128;
+spsc_fifo<uint32_t,100> spsc_fifo_100;
+spsc_fifo<uint32_t,128> spsc_fifo_128;
+circular_spsc_fifo<uint32_t,100> circular_spsc_fifo_100;
+circular_spsc_fifo<uint32_t,128> circular_spsc_fifo_128;
+
+void setup() {
+  // put your setup code here, to run once:
+
+  Serial.begin(9600);
+
+  // enabling the DWT cycle counter
+  CoreDebug->DEMCR|=CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT=0;
+  DWT->CTRL|=DWT_CTRL_CYCCNTENA_Msk;
+}
+
+void loop() {
+  // put your main code here,to run repeatedly:
+  Serial.println("========================================================");
+
+  benchmark("fifo<uint32_t,100>",fifo_100);
+  benchmark("fifo<uint32_t,128>",fifo_128);
+  benchmark("circular_fifo<uint32_t,100>",circular_fifo_100);
+  benchmark("circular_fifo<uint32_t,128>",circular_fifo_128);
+  benchmark("spsc_fifo<uint32_t,100>",spsc_fifo_100);
+  benchmark("spsc_fifo<uint32_t,128>",spsc_fifo_128);
+  benchmark("circular_spsc_fifo<uint32_t,100>",circular_spsc_fifo_100);
+  benchmark("circular_spsc_fifo<uint32_t,128>",circular_spsc_fifo_128);
+
+  delay(5000);
+}
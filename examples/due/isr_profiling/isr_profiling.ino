@@ -0,0 +1,155 @@
+/**
+ ** soft_uart library
+ ** Copyright (C) 2015-2020
+ **
+ **   Antonio C. Domínguez Brito <antonio.dominguez@ulpgc.es>
+ **     División de Robótica y Oceanografía Computacional <www.roc.siani.es>
+ **     and Departamento de Informática y Sistemas <www.dis.ulpgc.es>
+ **     Universidad de Las Palmas de Gran  Canaria (ULPGC) <www.ulpgc.es>
+ **  
+ ** This file is part of the soft_uart library.
+ ** The soft_uart library is free software: you can redistribute it and/or modify
+ ** it under  the  terms of  the GNU  General  Public  License  as  published  by
+ ** the  Free Software Foundation, either  version  3  of  the  License,  or  any
+ ** later version.
+ ** 
+ ** The  soft_uart library is distributed in the hope that  it  will  be  useful,
+ ** but   WITHOUT   ANY WARRANTY;   without   even   the  implied   warranty   of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR  PURPOSE.  See  the  GNU  General
+ ** Public License for more details.
+ ** 
+ ** You should have received a copy  (COPYING file) of  the  GNU  General  Public
+ ** License along with the soft_uart library.
+ ** If not, see: <http://www.gnu.org/licenses/>.
+ **/
+/*
+ * File: isr_profiling.ino 
+ * Description: This is an example illustrating the profiling of the 
+ * interrupt handlers of the soft_uart library (macro 
+ * SOFT_UART_ISR_PROFILING). Software serial port object serial_tc4 sends 
+ * frames to serial_tc5 at every framing, and the CPU cycles taken by the 
+ * TC and RX pin interrupt handlers of both objects are printed. For the
+ * example to work, pin 11 (TX of serial_tc4) must be wired to pin 12 (RX 
+ * of serial_tc5), and pin 13 (TX of serial_tc5) to pin 10 (RX of 
+ * serial_tc4).
+ * Date: October 17th, 2026
+ * Author: Antonio C. Dominguez-Brito <antonio.dominguez@ulpgc.es>
+ * ROC-SIANI - Universidad de Las Palmas de Gran Canaria - Spain
+ */
+
+// NOTE: it must be defined before including soft_uart.h
+#define SOFT_UART_ISR_PROFILING
+
+#include "soft_uart.h"
+
+using namespace soft_uart;
+using namespace soft_uart::arduino_due;
+
+#define SOFT_UART_BIT_RATE 57600
+#define RX_BUF_LENGTH 256 
+#define TX_BUF_LENGTH 256 
+#define FRAMES 1000
+
+serial_tc4_declaration(RX_BUF_LENGTH,TX_BUF_LENGTH);
+serial_tc5_declaration(RX_BUF_LENGTH,TX_BUF_LENGTH);
+
+void print_profile(const char* name,isr_profile profile)
+{
+  Serial.print(name);
+  Serial.print(": count "); Serial.print(profile.count);
+  Serial.print(", min "); Serial.print(profile.min);
+  Serial.print(", mean "); Serial.print(profile.get_mean());
+  Serial.print(", max "); Serial.print(profile.max);
+  Serial.print(" cycles, histogram");
+  for(uint32_t i=0; i<ISR_PROFILE_BINS; i++)
+  { Serial.print(" "); Serial.print(profile.histogram[i]); }
+  Serial.println();
+}
+
+void profile(
+  const char* name,
+  data_bit_codes the_data_bits,
+  parity_codes the_parity,
+  stop_bit_codes the_stop_bits,
+  rx_decoder_codes the_rx_decoder,
+  tx_encoder_codes the_tx_encoder
+)
+{
+  serial_tc4.begin(
+    10,11,SOFT_UART_BIT_RATE,
+    the_data_bits,the_parity,the_stop_bits,
+    the_rx_decoder,the_tx_encoder
+  );
+  serial_tc5.begin(
+    12,13,SOFT_UART_BIT_RATE,
+    the_data_bits,the_parity,the_stop_bits,
+    the_rx_decoder,the_tx_encoder
+  );
+
+  uint32_t mask=(1<<static_cast<uint32_t>(the_data_bits))-1;
+  for(uint32_t i=0; i<FRAMES; i++) 
+  {
+    serial_tc4.write(i&mask);
+    while(serial_tc5.available()) serial_tc5.read();
+  }
+  serial_tc4.flush();
+  delay(10);
+
+  Serial.println(name);
+  print_profile("  serial_tc4 TC ",serial_tc4.get_tc_isr_profile());
+  print_profile("  serial_tc4 RX ",serial_tc4.get_rx_isr_profile());
+  print_profile("  serial_tc5 TC ",serial_tc5.get_tc_isr_profile());
+  print_profile("  serial_tc5 RX ",serial_tc5.get_rx_isr_profile());
+
+  serial_tc4.end(); serial_tc5.end();
+}
+
+void setup() {
+  // put your setup code here, to run once:
+
+  Serial.begin(9600);
+}
+
+void loop() {
+  // put your main code here,to run repeatedly:
+  Serial.println("========================================================");
+
+  profile(
+    "8N1 OVERSAMPLING/PER_BIT",
+    data_bit_codes::EIGHT_BITS,parity_codes::NO_PARITY,
+    stop_bit_codes::ONE_STOP_BIT,
+    rx_decoder_codes::OVERSAMPLING,tx_encoder_codes::PER_BIT
+  );
+  profile(
+    "8E1 OVERSAMPLING/PER_BIT",
+    data_bit_codes::EIGHT_BITS,parity_codes::EVEN_PARITY,
+    stop_bit_codes::ONE_STOP_BIT,
+    rx_decoder_codes::OVERSAMPLING,tx_encoder_codes::PER_BIT
+  );
+  profile(
+    "9O2 OVERSAMPLING/PER_BIT",
+    data_bit_codes::NINE_BITS,parity_codes::ODD_PARITY,
+    stop_bit_codes::TWO_STOP_BITS,
+    rx_decoder_codes::OVERSAMPLING,tx_encoder_codes::PER_BIT
+  );
+  profile(
+    "8N1 EDGE_TIMESTAMPS/RUN_LENGTH",
+    data_bit_codes::EIGHT_BITS,parity_codes::NO_PARITY,
+    stop_bit_codes::ONE_STOP_BIT,
+    rx_decoder_codes::EDGE_TIMESTAMPS,tx_encoder_codes::RUN_LENGTH
+  );
+  profile(
+    "8E1 EDGE_TIMESTAMPS/RUN_LENGTH",
+    data_bit_codes::EIGHT_BITS,parity_codes::EVEN_PARITY,
+    stop_bit_codes::ONE_STOP_BIT,
+    rx_decoder_codes::EDGE_TIMESTAMPS,tx_encoder_codes::RUN_LENGTH
+  );
+  profile(
+    "9O2 EDGE_TIMESTAMPS/RUN_LENGTH",
+    data_bit_codes::NINE_BITS,parity_codes::ODD_PARITY,
+    stop_bit_codes::TWO_STOP_BITS,
+    rx_decoder_codes::EDGE_TIMESTAMPS,tx_encoder_codes::RUN_LENGTH
+  );
+
+  delay(5000);
+}
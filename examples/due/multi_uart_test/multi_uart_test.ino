@@ -0,0 +1,104 @@
+/**
+ ** soft_uart library
+ ** Copyright (C) 2015-2020
+ **
+ **   Antonio C. Domínguez Brito <antonio.dominguez@ulpgc.es>
+ **     División de Robótica y Oceanografía Computacional <www.roc.siani.es>
+ **     and Departamento de Informática y Sistemas <www.dis.ulpgc.es>
+ **     Universidad de Las Palmas de Gran  Canaria (ULPGC) <www.ulpgc.es>
+ **  
+ ** This file is part of the soft_uart library.
+ ** The soft_uart library is free software: you can redistribute it and/or modify
+ ** it under  the  terms of  the GNU  General  Public  License  as  published  by
+ ** the  Free Software Foundation, either  version  3  of  the  License,  or  any
+ ** later version.
+ ** 
+ ** The  soft_uart library is distributed in the hope that  it  will  be  useful,
+ ** but   WITHOUT   ANY WARRANTY;   without   even   the  implied   warranty   of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR  PURPOSE.  See  the  GNU  General
+ ** Public License for more details.
+ ** 
+ ** You should have received a copy  (COPYING file) of  the  GNU  General  Public
+ ** License along with the soft_uart library.
+ ** If not, see: <http://www.gnu.org/licenses/>.
+ **/
+/*
+ * File: multi_uart_test.ino 
+ * Description: This is an example illustrating the use of the multi-port
+ * engines of the soft_uart library. Four TX ports (pins 33, 34, 35 and 36)
+ * share timer/counter channel TC5, and four RX ports (pins 37, 38, 39 and 40)
+ * share timer/counter channel TC3. For having this example working, you 
+ * should connect pin 33 to pin 37, pin 34 to pin 38, pin 35 to pin 39 and
+ * pin 36 to pin 40.
+ * Date: October 17th, 2026
+ * Author: Antonio C. Dominguez-Brito <antonio.dominguez@ulpgc.es>
+ * ROC-SIANI - Universidad de Las Palmas de Gran Canaria - Spain
+ */
+
+#include "multi_uart.h"
+
+using namespace soft_uart;
+using namespace soft_uart::arduino_due;
+
+#define SOFT_UART_BIT_RATE 19200 // 57600 38400 1200 19200 9600 115200 300
+#define RX_BUF_LENGTH 64 // reception buffer length of each port
+#define TX_BUF_LENGTH 64 // transmision buffer length of each port
+
+// declaration of multi-port objects rx_ports (TC3) and tx_ports (TC5)
+multi_uart_rx_declaration(3,rx_ports,RX_BUF_LENGTH,37,38,39,40);
+multi_uart_tx_declaration(5,tx_ports,TX_BUF_LENGTH,33,34,35,36);
+
+uint32_t counter=0;
+
+void setup() {
+  // put your setup code here, to run once:
+
+  Serial.begin(9600);
+
+  rx_ports.config(
+    SOFT_UART_BIT_RATE,
+    soft_uart::data_bit_codes::EIGHT_BITS,
+    soft_uart::parity_codes::EVEN_PARITY,
+    soft_uart::stop_bit_codes::ONE_STOP_BIT
+  );
+
+  tx_ports.config(
+    SOFT_UART_BIT_RATE,
+    soft_uart::data_bit_codes::EIGHT_BITS,
+    soft_uart::parity_codes::EVEN_PARITY,
+    soft_uart::stop_bit_codes::ONE_STOP_BIT
+  );
+
+  Serial.println("========================================================");
+  Serial.println("========================================================");
+  Serial.println("========================================================");  
+}
+
+void loop() {
+  // put your main code here,to run repeatedly:
+  Serial.println("********************************************************");
+
+  // every port sends a different byte at the same time
+  for(uint32_t port=0; port<tx_ports.get_ports(); port++)
+  {
+    Serial.print("--> [tx port "); Serial.print(port); 
+    Serial.print("] sending: "); Serial.println((counter+port)&0xff);
+    tx_ports.set_tx_data(port,(counter+port)&0xff);
+  }
+  tx_ports.flush();
+  delay(10);
+
+  for(uint32_t port=0; port<rx_ports.get_ports(); port++)
+  {
+    uint32_t data;
+    uint32_t status=rx_ports.get_rx_data(port,data);
+
+    Serial.print("<-- [rx port "); Serial.print(port); Serial.print("] "); 
+    if(!rx_ports.data_available(status)) Serial.println("nothing received!");
+    else if(rx_ports.bad_status(status)) Serial.println("bad frame received!");
+    else { Serial.print("received: "); Serial.println(data); }
+  }
+
+  counter++;
+  delay(1000);
+}
@@ -0,0 +1,245 @@
+/**
+ ** soft_uart library
+ ** Copyright (C) 2015-2020
+ **
+ **   Antonio C. Domínguez Brito <antonio.dominguez@ulpgc.es>
+ **     División de Robótica y Oceanografía Computacional <www.roc.siani.es>
+ **     and Departamento de Informática y Sistemas <www.dis.ulpgc.es>
+ **     Universidad de Las Palmas de Gran  Canaria (ULPGC) <www.ulpgc.es>
+ **  
+ ** This file is part of the soft_uart library.
+ ** The soft_uart library is free software: you can redistribute it and/or modify
+ ** it under  the  terms of  the GNU  General  Public  License  as  published  by
+ ** the  Free Software Foundation, either  version  3  of  the  License,  or  any
+ ** later version.
+ ** 
+ ** The  soft_uart library is distributed in the hope that  it  will  be  useful,
+ ** but   WITHOUT   ANY WARRANTY;   without   even   the  implied   warranty   of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR  PURPOSE.  See  the  GNU  General
+ ** Public License for more details.
+ ** 
+ ** You should have received a copy  (COPYING file) of  the  GNU  General  Public
+ ** License along with the soft_uart library.
+ ** If not, see: <http://www.gnu.org/licenses/>.
+ **/
+/*
+ * File: bit_timing_test.cpp 
+ * Description: This is an example checking the fixed point (24.8 ticks) 
+ * bit timing of the soft_uart library on the host port. For each standard 
+ * bit rate from 75 to 115200 bps, at the TC tick rate of the Arduino DUE
+ * (VARIANT_MCK/2), the transmission deadlines accumulated along a stream
+ * of frames, the mid-bit sample positions of the reception decoder, and
+ * the quarters of bit of the OVERSAMPLING timer are compared against the
+ * exact positions k*tick_rate/bit_rate. The edges sent by a uart with the
+ * default OVERSAMPLING decoder and PER_BIT encoder along a stream of 
+ * frames are checked the same way, on the simulated TC.
+ * Date: October 18th, 2026
+ * Author: Antonio C. Dominguez-Brito <antonio.dominguez@ulpgc.es>
+ * ROC-SIANI - Universidad de Las Palmas de Gran Canaria - Spain
+ */
+
+#include <cstdio>
+#include <cmath>
+
+#include "soft_uart.h"
+
+using namespace soft_uart;
+using namespace soft_uart::arduino_due;
+
+#define TICK_RATE ((VARIANT_MCK)>>1)
+#define STREAM_FRAMES 100
+#define FRAME_BITS 10
+// NOTE: start bit, nine data bits, parity and two stop bits
+#define MAX_FRAME_BITS 13
+#define RX_BUF_LENGTH 16
+#define TX_BUF_LENGTH 16
+
+serial_tc4_declaration(RX_BUF_LENGTH,TX_BUF_LENGTH);
+
+const uint32_t standard_bit_rates[]=
+{ 
+  75, 110, 150, 300, 600, 1200, 2400, 4800, 9600, 14400, 19200, 28800, 
+  38400, 57600, 76800, 115200 
+};
+
+// NOTE: the bit length is rounded to the nearest 1/256 of tick, so each
+// bit is off by 1/512 of tick at most, and the deadlines and samples are
+// truncated to whole ticks (less than a tick), so after k bits the error
+// bound is 1+k/512 ticks (the sample of bit k is k+0.5 bits away from the
+// start of the frame, one bit more is allowed for it)
+double error_bound(uint32_t bits)
+{ return 1.0+static_cast<double>(bits)/(2<<TICK_FRACTION_BITS); }
+
+double exact_ticks(double bits,uint32_t bit_rate)
+{ return bits*TICK_RATE/bit_rate; }
+
+// NOTE: deadlines accumulated along a stream of frames, advancing them 
+// in runs of 1 to 4 bits, as the run-length encoders do
+uint32_t check_deadlines(
+  uint32_t bit_rate,
+  uint32_t fixed_bit_ticks,
+  double& max_error
+)
+{
+  uint32_t errors=0;
+  uint32_t deadline=0;
+  uint32_t fraction=0;
+  uint32_t bits=0;
+  uint32_t run=1;
+
+  while(bits<STREAM_FRAMES*FRAME_BITS)
+  {
+    deadline+=advance_fixed_ticks(run,fixed_bit_ticks,fraction);
+    bits+=run; run=(run&3)+1;
+
+    double error=std::fabs(deadline-exact_ticks(bits,bit_rate));
+    if(error>max_error) max_error=error;
+    if(error>=error_bound(bits)) errors++;
+  }
+
+  return errors;
+}
+
+uint32_t check_samples(
+  uint32_t bit_rate,
+  uint32_t fixed_bit_ticks,
+  double& max_error
+)
+{
+  uint32_t errors=0;
+
+  for(uint32_t bit=0; bit<MAX_FRAME_BITS; bit++)
+  {
+    double error=std::fabs(
+      get_bit_sample_ticks(fixed_bit_ticks,bit)-
+        exact_ticks(bit+0.5,bit_rate)
+    );
+    if(error>max_error) max_error=error;
+    if(error>=error_bound(bit+1)) errors++;
+  }
+
+  return errors;
+}
+
+// NOTE: the quarters of bit accumulated along a stream of frames, as
+// the OVERSAMPLING timer runs them (rounded to the nearest from its start)
+uint32_t check_quarters(
+  uint32_t bit_rate,
+  uint32_t fixed_bit_ticks,
+  double& max_error
+)
+{
+  uint32_t errors=0;
+  uint32_t ticks=0;
+  uint32_t fraction=(1<<(TICK_FRACTION_BITS+1));
+
+  for(uint32_t quarter=1; quarter<=(STREAM_FRAMES*FRAME_BITS<<2); quarter++)
+  {
+    ticks+=advance_quarter_ticks(fixed_bit_ticks,fraction);
+
+    double error=std::fabs(ticks-exact_ticks(quarter/4.0,bit_rate));
+    if(error>max_error) max_error=error;
+    if(error>=error_bound((quarter+3)>>2)) errors++;
+  }
+
+  return errors;
+}
+
+// NOTE: the times of the edges of the TX pin, in TC ticks
+#define TX_PIN 3
+#define MAX_EDGES (STREAM_FRAMES*FRAME_BITS)
+
+double edge_ticks[MAX_EDGES];
+uint32_t edges=0;
+
+void tx_pin_change(uint32_t,uint32_t)
+{
+  if(edges<MAX_EDGES)
+    edge_ticks[edges]=
+      static_cast<double>(host::get_time())/double(host::SIM_TICK);
+  edges++;
+}
+
+// NOTE: frames 0x55 (8N1) sent back to back toggle the line on every 
+// bit, so edge k must be k bits after the first one, the timer is not
+// restarted along the stream
+uint32_t check_tx_edges(uint32_t bit_rate,double& max_error)
+{
+  uint32_t errors=0;
+
+  // 8N1, OVERSAMPLING and PER_BIT by default
+  serial_tc4.begin(2,TX_PIN,bit_rate);
+
+  edges=0;
+  host::on_pin_change(TX_PIN,tx_pin_change);
+
+  for(uint32_t frame=0; frame<STREAM_FRAMES; frame++)
+  {
+    while(!serial_tc4.available_for_write()) host::busy_wait();
+    serial_tc4.write(static_cast<uint8_t>(0x55));
+  }
+  serial_tc4.flush();
+
+  host::on_pin_change(TX_PIN,nullptr);
+  serial_tc4.end();
+
+  if(edges!=MAX_EDGES) return 1;
+
+  for(uint32_t edge=1; edge<edges; edge++)
+  {
+    double error=std::fabs(
+      (edge_ticks[edge]-edge_ticks[0])-exact_ticks(edge,bit_rate)
+    );
+    if(error>max_error) max_error=error;
+    if(error>=error_bound(edge)) errors++;
+  }
+
+  return errors;
+}
+
+int main()
+{
+  uint32_t failures=0;
+
+  printf(
+    "tick rate %u Hz, %u bits per deadline stream, %u samples per frame\n",
+    static_cast<unsigned>(TICK_RATE),
+    static_cast<unsigned>(STREAM_FRAMES*FRAME_BITS),
+    static_cast<unsigned>(MAX_FRAME_BITS)
+  );
+  printf(
+    "%8s %14s %22s %22s %22s %22s\n",
+    "bps","ticks/bit","max. deadline error","max. sample error",
+    "max. quarter error","max. TX edge error"
+  );
+
+  for(auto bit_rate: standard_bit_rates)
+  {
+    uint32_t fixed_bit_ticks=get_fixed_bit_ticks(TICK_RATE,bit_rate);
+    double deadline_error=0, sample_error=0;
+    double quarter_error=0, edge_error=0;
+    uint32_t errors=
+      check_deadlines(bit_rate,fixed_bit_ticks,deadline_error)+
+      check_samples(bit_rate,fixed_bit_ticks,sample_error)+
+      check_quarters(bit_rate,fixed_bit_ticks,quarter_error)+
+      check_tx_edges(bit_rate,edge_error);
+    double bit_ticks=exact_ticks(1,bit_rate);
+
+    printf(
+      "%8u %14.3f %9.3f (%7.4f%%) %9.3f (%7.4f%%) "
+      "%9.3f (%7.4f%%) %9.3f (%7.4f%%) %s\n",
+      static_cast<unsigned>(bit_rate),
+      bit_ticks,
+      deadline_error, 100*deadline_error/bit_ticks,
+      sample_error, 100*sample_error/bit_ticks,
+      quarter_error, 100*quarter_error/bit_ticks,
+      edge_error, 100*edge_error/bit_ticks,
+      (errors)? "FAILED": "ok"
+    );
+
+    if(errors) failures++;
+  }
+
+  printf((failures)? "FAILED\n": "OK\n");
+  return (failures)? 1: 0;
+}
@@ -0,0 +1,607 @@
+/**
+ ** soft_uart library
+ ** Copyright (C) 2015-2020
+ **
+ **   Antonio C. Domínguez Brito <antonio.dominguez@ulpgc.es>
+ **     División de Robótica y Oceanografía Computacional <www.roc.siani.es>
+ **     and Departamento de Informática y Sistemas <www.dis.ulpgc.es>
+ **     Universidad de Las Palmas de Gran  Canaria (ULPGC) <www.ulpgc.es>
+ **  
+ ** This file is part of the soft_uart library.
+ ** The soft_uart library is free software: you can redistribute it and/or modify
+ ** it under  the  terms of  the GNU  General  Public  License  as  published  by
+ ** the  Free Software Foundation, either  version  3  of  the  License,  or  any
+ ** later version.
+ ** 
+ ** The  soft_uart library is distributed in the hope that  it  will  be  useful,
+ ** but   WITHOUT   ANY WARRANTY;   without   even   the  implied   warranty   of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR  PURPOSE.  See  the  GNU  General
+ ** Public License for more details.
+ ** 
+ ** You should have received a copy  (COPYING file) of  the  GNU  General  Public
+ ** License along with the soft_uart library.
+ ** If not, see: <http://www.gnu.org/licenses/>.
+ **/
+/*
+ * File: host_basic_test.cpp 
+ * Description: This is an example illustrating the use of the soft_uart
+ * library on the host port (simulated peripherals). Two pairs of software
+ * serial port objects, with their TX pins wired to the RX pins of the other
+ * one, exchange data with the different reception decoders and transmission
+ * encoders, and packets delimited by idle line detection. The uart core 
+ * shared by the ports is also checked alone, on a loopback platform without
+ * bit engine, and with its OVERSAMPLING engine driven by a host policy.
+ * Date: October 17th, 2026
+ * Author: Antonio C. Dominguez-Brito <antonio.dominguez@ulpgc.es>
+ * ROC-SIANI - Universidad de Las Palmas de Gran Canaria - Spain
+ */
+
+#include <cstdio>
+
+#include "soft_uart.h"
+
+using namespace soft_uart;
+using namespace soft_uart::arduino_due;
+
+#define SOFT_UART_BIT_RATE 57600
+#define RX_BUF_LENGTH 256 
+#define TX_BUF_LENGTH 256 
+#define FRAMES 1000
+
+serial_tc4_declaration(RX_BUF_LENGTH,TX_BUF_LENGTH);
+serial_tc5_declaration(RX_BUF_LENGTH,TX_BUF_LENGTH);
+
+// NOTE: pin 2 is TIOA0 and pin 3 TIOA7
+serial_tc0_declaration(RX_BUF_LENGTH,TX_BUF_LENGTH);
+serial_tc7_declaration(RX_BUF_LENGTH,TX_BUF_LENGTH);
+
+uint32_t wires[NUM_DIGITAL_PINS];
+
+void wire_callback(uint32_t pin,uint32_t level)
+{ host::drive_pin(wires[pin],level); }
+
+void wire(uint32_t from_pin,uint32_t to_pin)
+{
+  wires[from_pin]=to_pin;
+  host::on_pin_change(from_pin,wire_callback);
+  host::drive_pin(to_pin,host::get_pin_level(from_pin));
+}
+
+template<typename SENDER,typename RECEIVER>
+uint32_t transfer(const char* name,SENDER& sender,RECEIVER& receiver)
+{
+  uint32_t sent=0, received=0, errors=0;
+  uint32_t start=micros();
+
+  sender.reset_link_statistics(); receiver.reset_link_statistics();
+
+  while(received<FRAMES)
+  {
+    if((sent<FRAMES) && sender.available_for_write())
+      sender.write(static_cast<uint8_t>(sent++));
+
+    if(receiver.available())
+    {
+      int data=receiver.read();
+      if(data!=static_cast<uint8_t>(received)) errors++;
+      received++;
+    }
+    else host::busy_wait();
+
+    // nothing more to receive
+    if(micros()-start>1000000) break;
+  }
+
+  printf(
+    "%s: %u frames sent, %u received, %u errors, %u us\n",
+    name,
+    static_cast<unsigned>(sent),
+    static_cast<unsigned>(received),
+    static_cast<unsigned>(errors),
+    static_cast<unsigned>(micros()-start)
+  );
+
+  // the link statistics must agree
+  link_statistics sender_statistics=sender.get_link_statistics();
+  link_statistics receiver_statistics=receiver.get_link_statistics();
+  if(
+    (sender_statistics.frames_sent!=sent) ||
+    (receiver_statistics.frames_received!=received) ||
+    receiver_statistics.overruns ||
+    receiver_statistics.bad_start_bits ||
+    receiver_statistics.bad_parities ||
+    receiver_statistics.bad_stop_bits
+  ) errors++;
+
+  return ((received==FRAMES) && !errors)? 0: 1;
+}
+
+// NOTE: blocks shorter than the RX buffer, written and read at once
+template<typename SENDER,typename RECEIVER>
+uint32_t block_transfer(const char* name,SENDER& sender,RECEIVER& receiver)
+{
+  const uint32_t block_length=100;
+  uint8_t block[block_length];
+  uint32_t sent=0, received=0, errors=0;
+  uint32_t start=micros();
+
+  while(sent<FRAMES)
+  {
+    for(uint32_t i=0; i<block_length; i++) 
+      block[i]=static_cast<uint8_t>(sent+i);
+    sent+=sender.write(block,block_length);
+
+    while((received<sent) && (micros()-start<1000000))
+    {
+      uint8_t data[block_length];
+      uint32_t statuses[block_length];
+      size_t read=receiver.read(data,sent-received,statuses);
+      if(!read) { host::busy_wait(); continue; }
+
+      for(size_t i=0; i<read; i++, received++)
+        if(
+          (data[i]!=static_cast<uint8_t>(received)) ||
+          receiver.bad_status(statuses[i])
+        ) errors++;
+    }
+  }
+
+  printf(
+    "%s: %u frames sent, %u received, %u errors, %u us\n",
+    name,
+    static_cast<unsigned>(sent),
+    static_cast<unsigned>(received),
+    static_cast<unsigned>(errors),
+    static_cast<unsigned>(micros()-start)
+  );
+
+  return ((received==sent) && !errors)? 0: 1;
+}
+
+// the received frames are read in place on the reception buffer
+template<typename SENDER,typename RECEIVER>
+uint32_t zero_copy_transfer(
+  const char* name,
+  SENDER& sender,
+  RECEIVER& receiver
+)
+{
+  uint32_t sent=0, received=0, errors=0;
+  uint32_t start=micros();
+
+  while((received<FRAMES) && (micros()-start<1000000))
+  {
+    if((sent<FRAMES) && sender.available_for_write())
+      sender.write(static_cast<uint8_t>(sent++));
+
+    const frame_t* frames;
+    size_t run=receiver.peek_contiguous(frames);
+    if(!run) { host::busy_wait(); continue; }
+
+    for(size_t i=0; i<run; i++, received++)
+      if(
+        (receiver.get_frame_data(frames[i])!=(received&0xFF)) ||
+        receiver.bad_status(receiver.get_frame_status(frames[i]))
+      ) errors++;
+
+    if(!receiver.consume(run)) errors++;
+  }
+
+  printf(
+    "%s: %u frames sent, %u received, %u errors, %u us\n",
+    name,
+    static_cast<unsigned>(sent),
+    static_cast<unsigned>(received),
+    static_cast<unsigned>(errors),
+    static_cast<unsigned>(micros()-start)
+  );
+
+  return ((received==sent) && !errors)? 0: 1;
+}
+
+// NOTE: with the interrupts disabled for longer than a bit in the middle
+// of a frame, WAVEFORM can not program the next edge in time, so that 
+// frame must be aborted, not sent with a stretched bit, and the frames
+// before and after it received fine
+template<typename SENDER,typename RECEIVER>
+uint32_t aborted_transfer(const char* name,SENDER& sender,RECEIVER& receiver)
+{
+  const uint32_t frames=8;
+  const uint32_t bit_ticks=(VARIANT_MCK>>1)/SOFT_UART_BIT_RATE;
+  uint8_t block[frames];
+  uint8_t data[2*frames];
+  uint32_t statuses[2*frames];
+  uint32_t errors=0;
+
+  // NOTE: every run is one bit long, so every edge is missed
+  for(uint32_t i=0; i<frames; i++) block[i]=(i&1)? 0xAA: 0x55;
+
+  sender.reset_link_statistics(); receiver.flushRX();
+  sender.write(block,frames);
+
+  // in the middle of the second frame
+  host::run_for(14*bit_ticks);
+  __disable_irq(); host::run_for(3*bit_ticks); __enable_irq();
+
+  sender.flush(); host::run_for(2*frames*bit_ticks);
+  size_t received=receiver.read(data,2*frames,statuses);
+
+  if(sender.get_link_statistics().tx_aborted_frames!=1) errors++;
+
+  // the first frame, and the ones after the aborted one
+  if(received<frames-1) errors++;
+  else
+  {
+    if((data[0]!=block[0]) || receiver.bad_status(statuses[0])) errors++;
+    for(uint32_t i=2; i<frames; i++)
+    {
+      size_t j=received-frames+i;
+      if((data[j]!=block[i]) || receiver.bad_status(statuses[j])) errors++;
+    }
+  }
+
+  printf(
+    "%s: %u frames received, %u aborted, %u errors\n",
+    name,
+    static_cast<unsigned>(received),
+    static_cast<unsigned>(sender.get_link_statistics().tx_aborted_frames),
+    static_cast<unsigned>(errors)
+  );
+
+  return (errors)? 1: 0;
+}
+
+// NOTE: a platform on the uart core without any bit engine, its 
+// "transmission" moves the frames sent straight to its reception 
+// buffer, so framing, validation and buffering are checked alone
+struct loopback_platform: 
+  uart_core<loopback_platform,64,64,frame_format_8E1>
+{
+  void start_tx()
+  {
+    frame_t frame;
+    while(pop_tx_frame(frame)) push_rx_frame(frame);
+  }
+};
+
+uint32_t core_loopback()
+{
+  loopback_platform platform;
+  uint32_t errors=0;
+
+  for(uint32_t block=0; block<8; block++)
+  {
+    uint8_t sent[32], received[32];
+    uint32_t statuses[32];
+
+    for(uint32_t i=0; i<32; i++) sent[i]=static_cast<uint8_t>(block*32+i);
+    if(platform.set_tx_data(sent,32)!=32) errors++;
+
+    if(platform.get_rx_data(received,32,statuses)!=32) errors++;
+    for(uint32_t i=0; i<32; i++)
+      if((received[i]!=sent[i]) || platform.bad_status(statuses[i])) 
+        errors++;
+  }
+
+  // a frame with its parity bit flipped, counted as it is received, 
+  // and not again when its status is read
+  uint32_t status=platform.push_rx_frame(platform.get_tx_frame(0x55)^(1<<9));
+  if(!platform.bad_parity(status) || (platform.statistics.bad_parities!=1)) 
+    errors++;
+
+  const frame_t* frames;
+  if(platform.rx_buffer.peek_contiguous(frames)!=1) errors++;
+  else if(
+    !platform.bad_parity(platform.get_rx_frame_status(frames[0])) ||
+    !platform.bad_parity(platform.get_rx_frame_status(frames[0]))
+  ) errors++;
+
+  uint32_t data;
+  if(!platform.bad_parity(platform.get_rx_data(data))) errors++;
+
+  if(
+    (platform.statistics.frames_sent!=256) ||
+    (platform.statistics.frames_received!=257) ||
+    (platform.statistics.bad_parities!=1)
+  ) errors++;
+
+  printf("uart core loopback: %u errors\n",static_cast<unsigned>(errors));
+
+  return (errors)? 1: 0;
+}
+
+// NOTE: a host policy for the OVERSAMPLING engine of the uart core, with
+// its TX pin wired to its RX pin, and a timer which is just a flag and a
+// period, the engine is called on each quarter of bit while the timer 
+// runs, and on each change of the line, and its hooks (and the changes
+// of the period) must be called with the lock taken
+struct host_policy_lock
+{
+  host_policy_lock() { locks++; }
+  ~host_policy_lock() { locks--; }
+
+  static uint32_t locks;
+};
+
+uint32_t host_policy_lock::locks=0;
+
+struct host_policy_platform: 
+  uart_core<host_policy_platform,64,64,frame_format_8E1>
+{
+  typedef host_policy_lock isr_guard;
+  typedef host_policy_lock thread_guard;
+
+  void start_tx() { start_oversampling_tx(); }
+
+  void start_timer(uint32_t ticks) { timer_running=true; timer_ticks=ticks; }
+  void set_timer_period(uint32_t ticks) { check_lock(); timer_ticks=ticks; }
+  void stop_timer() { timer_running=false; }
+
+  uint32_t read_rx_pin() { return rx_level; }
+  void write_tx_pin(uint32_t level) { tx_level=level; }
+
+  void rx_frame_hook() { check_lock(); rx_frames++; }
+  void tx_frame_hook() { check_lock(); tx_frames++; }
+  void tx_end_hook() { check_lock(); tx_ends++; }
+  void rx_idle_hook() { check_lock(); rx_idles++; }
+
+  void check_lock() { if(!host_policy_lock::locks) unlocked_hooks++; }
+
+  bool timer_running;
+  uint32_t timer_ticks;
+  uint32_t rx_level;
+  uint32_t tx_level;
+
+  uint32_t rx_frames;
+  uint32_t tx_frames;
+  uint32_t tx_ends;
+  uint32_t rx_idles;
+  uint32_t unlocked_hooks;
+};
+
+uint32_t engine_loopback()
+{
+  const uint32_t frames=32;
+  const uint32_t idle_bits=4;
+  host_policy_platform platform;
+  uint8_t sent[frames], received[frames+1];
+  uint32_t statuses[frames+1];
+  uint32_t errors=0;
+
+  platform.reset_engine();
+  platform.set_oversampling_bit_ticks(
+    get_fixed_bit_ticks((VARIANT_MCK)>>1,115200)
+  );
+  platform.rx_idle_bits=idle_bits; platform.rx_idle_quarters=idle_bits<<2;
+  platform.timer_running=false;
+  platform.rx_level=platform.tx_level=1;
+  platform.rx_frames=platform.tx_frames=platform.tx_ends=0;
+  platform.rx_idles=platform.unlocked_hooks=0;
+
+  for(uint32_t i=0; i<frames; i++) sent[i]=static_cast<uint8_t>(i*37+1);
+  if(platform.set_tx_data(sent,frames)!=frames) errors++;
+
+  // NOTE: up to the end of the frames, and the idle line timeout, in 
+  // quarters of bit, with some margin, the timer is not restarted, so
+  // its ticks must keep on the exact quarters (rounded to the nearest)
+  const uint32_t max_quarters=
+    ((frames*platform.format.tx_frame_bits)+idle_bits+4)<<2;
+  uint32_t quarter=0;
+  uint64_t timer_ticks=0;
+  for(; platform.timer_running && (quarter<max_quarters); quarter++)
+  {
+    timer_ticks+=platform.timer_ticks;
+    if(
+      timer_ticks!=
+        (
+          (uint64_t(quarter+1)*platform.oversampling_bit_ticks+
+            (1<<(TICK_FRACTION_BITS+1)))>>(TICK_FRACTION_BITS+2)
+        )
+    ) errors++;
+
+    platform.oversampling_interrupt();
+
+    if(platform.rx_level!=platform.tx_level)
+    { platform.rx_level=platform.tx_level; platform.oversampling_rx_edge(); }
+  }
+
+  // the frames, and the idle line mark after them
+  size_t count=platform.get_rx_data(received,frames+1,statuses);
+  if(count!=frames+1) errors++;
+  else
+  {
+    for(uint32_t i=0; i<frames; i++)
+      if((received[i]!=sent[i]) || platform.bad_status(statuses[i])) 
+        errors++;
+    if(!platform.idle_line(statuses[frames])) errors++;
+  }
+
+  if(
+    platform.timer_running ||
+    (platform.get_tx_status()!=tx_status_codes::IDLE) ||
+    (platform.rx_frames!=frames) || (platform.tx_frames!=frames) ||
+    (platform.tx_ends!=1) || (platform.rx_idles!=1) ||
+    platform.unlocked_hooks || host_policy_lock::locks ||
+    (platform.statistics.frames_sent!=frames) ||
+    (platform.statistics.frames_received!=frames)
+  ) errors++;
+
+  printf(
+    "uart core OVERSAMPLING engine loopback: %u frames received, %u errors\n",
+    static_cast<unsigned>(count),
+    static_cast<unsigned>(errors)
+  );
+
+  return (errors)? 1: 0;
+}
+
+// the frames encoded with the tables selected at runtime must be the 
+// ones encoded bit by bit
+uint32_t frame_tables()
+{
+  const parity_codes parities[]=
+    { parity_codes::EVEN_PARITY, parity_codes::ODD_PARITY };
+  const stop_bit_codes stop_bits[]=
+    { stop_bit_codes::ONE_STOP_BIT, stop_bit_codes::TWO_STOP_BITS };
+  uint32_t errors=0;
+
+  for(uint32_t p=0; p<2; p++)
+    for(uint32_t s=0; s<2; s++)
+    {
+      runtime_frame_format format;
+      format.set(data_bit_codes::EIGHT_BITS,parities[p],stop_bits[s]);
+      if(!format.frame_table) { errors++; continue; }
+
+      runtime_frame_format bitwise=format;
+      bitwise.frame_table=nullptr;
+      for(uint32_t data=0; data<256; data++)
+        if(format.encode(data)!=bitwise.encode(data)) errors++;
+    }
+
+  printf("frame tables: %u errors\n",static_cast<unsigned>(errors));
+
+  return (errors)? 1: 0;
+}
+
+// NOTE: packets separated by more than the idle line timeout (3.5 
+// characters as on Modbus RTU), each one must end with an idle line mark
+template<typename SENDER,typename RECEIVER>
+uint32_t idle_transfer(const char* name,SENDER& sender,RECEIVER& receiver)
+{
+  const uint32_t packets=4;
+  const uint32_t packet_length=8;
+  const uint32_t idle_bits=39; // 3.5 characters of 11 bits
+  uint32_t received=0, marks=0, errors=0;
+  uint32_t start=micros();
+
+  receiver.set_rx_idle_timeout(idle_bits);
+  if(receiver.get_rx_idle_timeout()!=idle_bits) errors++;
+
+  for(uint32_t p=0; p<packets; p++)
+  {
+    uint8_t packet[packet_length];
+    for(uint32_t i=0; i<packet_length; i++) 
+      packet[i]=static_cast<uint8_t>(p*packet_length+i);
+    sender.write(packet,packet_length);
+
+    // the packet and its idle line mark
+    uint32_t packet_received=0;
+    bool packet_end=false;
+    while(!packet_end && (micros()-start<1000000))
+    {
+      uint8_t data[packet_length+1];
+      uint32_t statuses[packet_length+1];
+      size_t read=receiver.read(data,packet_length+1,statuses);
+      if(!read) { host::busy_wait(); continue; }
+
+      for(size_t i=0; i<read; i++)
+      {
+        if(packet_end) { errors++; continue; }
+
+        if(receiver.idle_line(statuses[i])) 
+        { 
+          marks++; packet_end=true;
+          if(packet_received!=packet_length) errors++;
+          continue;
+        }
+
+        if(
+          (data[i]!=static_cast<uint8_t>(received)) ||
+          receiver.bad_status(statuses[i])
+        ) errors++;
+        received++; packet_received++;
+      }
+    }
+  }
+
+  receiver.set_rx_idle_timeout(0);
+
+  printf(
+    "%s: %u frames received, %u idle line marks, %u errors, %u us\n",
+    name,
+    static_cast<unsigned>(received),
+    static_cast<unsigned>(marks),
+    static_cast<unsigned>(errors),
+    static_cast<unsigned>(micros()-start)
+  );
+
+  return (
+    (received==packets*packet_length) && (marks==packets) && !errors
+  )? 0: 1;
+}
+
+int main()
+{
+  uint32_t failures=0;
+
+  failures+=core_loopback();
+  failures+=engine_loopback();
+  failures+=frame_tables();
+
+  wire(11,12); wire(13,10);
+
+  // oversampling reception and per bit transmission
+  serial_tc4.begin(10,11,SOFT_UART_BIT_RATE);
+  serial_tc5.begin(12,13,SOFT_UART_BIT_RATE);
+  failures+=transfer("OVERSAMPLING/PER_BIT tc4->tc5",serial_tc4,serial_tc5);
+  failures+=transfer("OVERSAMPLING/PER_BIT tc5->tc4",serial_tc5,serial_tc4);
+  failures+=block_transfer(
+    "OVERSAMPLING/PER_BIT blocks tc4->tc5",serial_tc4,serial_tc5
+  );
+  failures+=idle_transfer(
+    "OVERSAMPLING/PER_BIT idle line tc4->tc5",serial_tc4,serial_tc5
+  );
+  serial_tc4.end(); serial_tc5.end();
+
+  // edge timestamps reception and run length transmission
+  serial_tc4.begin(
+    10,11,SOFT_UART_BIT_RATE,
+    data_bit_codes::EIGHT_BITS,parity_codes::EVEN_PARITY,
+    stop_bit_codes::ONE_STOP_BIT,
+    rx_decoder_codes::EDGE_TIMESTAMPS,tx_encoder_codes::RUN_LENGTH
+  );
+  serial_tc5.begin(
+    12,13,SOFT_UART_BIT_RATE,
+    data_bit_codes::EIGHT_BITS,parity_codes::EVEN_PARITY,
+    stop_bit_codes::ONE_STOP_BIT,
+    rx_decoder_codes::EDGE_TIMESTAMPS,tx_encoder_codes::RUN_LENGTH
+  );
+  failures+=transfer("EDGE_TIMESTAMPS/RUN_LENGTH tc4->tc5",serial_tc4,serial_tc5);
+  failures+=transfer("EDGE_TIMESTAMPS/RUN_LENGTH tc5->tc4",serial_tc5,serial_tc4);
+  failures+=block_transfer(
+    "EDGE_TIMESTAMPS/RUN_LENGTH blocks tc5->tc4",serial_tc5,serial_tc4
+  );
+  failures+=idle_transfer(
+    "EDGE_TIMESTAMPS/RUN_LENGTH idle line tc5->tc4",serial_tc5,serial_tc4
+  );
+  serial_tc4.end(); serial_tc5.end();
+
+  // input capture reception (on TIOA0) and waveform transmission (on 
+  // TIOA7)
+  wire(3,2); wire(22,23);
+  serial_tc0.begin(
+    2,22,SOFT_UART_BIT_RATE,
+    data_bit_codes::EIGHT_BITS,parity_codes::NO_PARITY,
+    stop_bit_codes::ONE_STOP_BIT,
+    rx_decoder_codes::INPUT_CAPTURE,tx_encoder_codes::RUN_LENGTH
+  );
+  serial_tc7.begin(
+    23,3,SOFT_UART_BIT_RATE,
+    data_bit_codes::EIGHT_BITS,parity_codes::NO_PARITY,
+    stop_bit_codes::ONE_STOP_BIT,
+    rx_decoder_codes::EDGE_TIMESTAMPS,tx_encoder_codes::WAVEFORM
+  );
+  failures+=transfer("WAVEFORM->INPUT_CAPTURE tc7->tc0",serial_tc7,serial_tc0);
+  failures+=transfer("RUN_LENGTH->EDGE_TIMESTAMPS tc0->tc7",serial_tc0,serial_tc7);
+  failures+=zero_copy_transfer(
+    "WAVEFORM->INPUT_CAPTURE zero-copy tc7->tc0",serial_tc7,serial_tc0
+  );
+  failures+=aborted_transfer(
+    "WAVEFORM->INPUT_CAPTURE aborted frame tc7->tc0",serial_tc7,serial_tc0
+  );
+  serial_tc0.end(); serial_tc7.end();
+
+  printf("%s\n",(failures)? "FAILED": "OK");
+
+  return (failures)? 1: 0;
+}
@@ -0,0 +1,233 @@
+/**
+ ** soft_uart library
+ ** Copyright (C) 2015-2020
+ **
+ **   Antonio C. Domínguez Brito <antonio.dominguez@ulpgc.es>
+ **     División de Robótica y Oceanografía Computacional <www.roc.siani.es>
+ **     and Departamento de Informática y Sistemas <www.dis.ulpgc.es>
+ **     Universidad de Las Palmas de Gran  Canaria (ULPGC) <www.ulpgc.es>
+ **  
+ ** This file is part of the soft_uart library.
+ ** The soft_uart library is free software: you can redistribute it and/or modify
+ ** it under  the  terms of  the GNU  General  Public  License  as  published  by
+ ** the  Free Software Foundation, either  version  3  of  the  License,  or  any
+ ** later version.
+ ** 
+ ** The  soft_uart library is distributed in the hope that  it  will  be  useful,
+ ** but   WITHOUT   ANY WARRANTY;   without   even   the  implied   warranty   of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR  PURPOSE.  See  the  GNU  General
+ ** Public License for more details.
+ ** 
+ ** You should have received a copy  (COPYING file) of  the  GNU  General  Public
+ ** License along with the soft_uart library.
+ ** If not, see: <http://www.gnu.org/licenses/>.
+ **/
+/*
+ * File: isr_profiling.cpp 
+ * Description: This is an example profiling the interrupt handlers of the
+ * soft_uart library on the host port (macro SOFT_UART_ISR_PROFILING), with
+ * the frame format set at runtime (runtime_frame_format) and at compile 
+ * time (frame_format_8E1). For each decoder and encoder, software serial 
+ * port objects serial_tc4 and serial_tc5 (runtime format), and serial_tc6 
+ * and serial_tc8 (compile-time format), send 8E1 frames to each other, and
+ * the cycles taken by the TC and RX pin interrupt handlers of the receivers
+ * are printed. On x86 hosts the cycles are read from the time stamp 
+ * counter, otherwise they are nanoseconds of the host clock, so they do 
+ * not tell the Cortex-M3 cycles, only the difference between formats.
+ * Date: October 18th, 2026
+ * Author: Antonio C. Dominguez-Brito <antonio.dominguez@ulpgc.es>
+ * ROC-SIANI - Universidad de Las Palmas de Gran Canaria - Spain
+ */
+
+#include <cstdio>
+#include <cstdint>
+
+// NOTE: they must be defined before including soft_uart.h
+#define SOFT_UART_ISR_PROFILING
+
+#if defined(__x86_64__) || defined(__i386__)
+
+  #include <x86intrin.h>
+
+  struct tsc_cycle_source
+  {
+    static void enable() {}
+    static uint32_t get_cycles() { return static_cast<uint32_t>(__rdtsc()); }
+  };
+
+  #define SOFT_UART_CYCLE_SOURCE tsc_cycle_source
+  #define CYCLE_UNITS "TSC cycles"
+
+#else
+
+  #define CYCLE_UNITS "ns"
+
+#endif
+
+#include "soft_uart.h"
+
+using namespace soft_uart;
+using namespace soft_uart::arduino_due;
+
+#define SOFT_UART_BIT_RATE 57600
+#define RX_BUF_LENGTH 256 
+#define TX_BUF_LENGTH 256 
+#define FRAMES 1000
+#define ROUNDS 8
+
+serial_tc4_declaration(RX_BUF_LENGTH,TX_BUF_LENGTH);
+serial_tc5_declaration(RX_BUF_LENGTH,TX_BUF_LENGTH);
+
+serial_tc_format_declaration(6,RX_BUF_LENGTH,TX_BUF_LENGTH,frame_format_8E1);
+serial_tc_format_declaration(8,RX_BUF_LENGTH,TX_BUF_LENGTH,frame_format_8E1);
+
+uint32_t wires[NUM_DIGITAL_PINS];
+
+void wire_callback(uint32_t pin,uint32_t level)
+{ host::drive_pin(wires[pin],level); }
+
+void wire(uint32_t from_pin,uint32_t to_pin)
+{
+  wires[from_pin]=to_pin;
+  host::on_pin_change(from_pin,wire_callback);
+  host::drive_pin(to_pin,host::get_pin_level(from_pin));
+}
+
+// NOTE: the profiles of all the rounds, merged, as the host may preempt
+// the simulation at any time, the maximum is not reliable, and the upper
+// bound of the histogram bin with the 99.9th percentile is also given
+struct merged_profile
+{
+  merged_profile(): max(0), sum(0), count(0)
+  { for(uint32_t i=0; i<ISR_PROFILE_BINS; i++) histogram[i]=0; }
+
+  void merge(const isr_profile& profile)
+  {
+    if(profile.max>max) max=profile.max;
+    sum+=profile.sum; count+=profile.count;
+    for(uint32_t i=0; i<ISR_PROFILE_BINS; i++) 
+      histogram[i]+=profile.histogram[i];
+  }
+
+  uint32_t get_mean()
+  { return (count)? static_cast<uint32_t>(sum/count): 0; }
+
+  uint32_t get_p999_bound()
+  {
+    uint64_t below=0;
+    for(uint32_t i=0; i<ISR_PROFILE_BINS; i++)
+    {
+      below+=histogram[i];
+      if(below*1000>=static_cast<uint64_t>(count)*999) return (2<<i)-1;
+    }
+    return max;
+  }
+
+  uint32_t max;
+  uint64_t sum;
+  uint32_t count;
+  uint32_t histogram[ISR_PROFILE_BINS];
+};
+
+template<typename SENDER,typename RECEIVER>
+void profile_round(
+  SENDER& sender,
+  uint32_t sender_pins[2],
+  RECEIVER& receiver,
+  uint32_t receiver_pins[2],
+  rx_decoder_codes the_rx_decoder,
+  tx_encoder_codes the_tx_encoder,
+  merged_profile& tc_profile,
+  merged_profile& rx_profile
+)
+{
+  sender.begin(
+    sender_pins[0],sender_pins[1],SOFT_UART_BIT_RATE,
+    data_bit_codes::EIGHT_BITS,parity_codes::EVEN_PARITY,
+    stop_bit_codes::ONE_STOP_BIT,the_rx_decoder,the_tx_encoder
+  );
+  receiver.begin(
+    receiver_pins[0],receiver_pins[1],SOFT_UART_BIT_RATE,
+    data_bit_codes::EIGHT_BITS,parity_codes::EVEN_PARITY,
+    stop_bit_codes::ONE_STOP_BIT,the_rx_decoder,the_tx_encoder
+  );
+
+  for(uint32_t i=0; i<FRAMES; i++) 
+  {
+    sender.write(static_cast<uint8_t>(i));
+    while(receiver.available()) receiver.read();
+  }
+  sender.flush(); delay(10);
+  while(receiver.available()) receiver.read();
+
+  tc_profile.merge(receiver.get_tc_isr_profile());
+  rx_profile.merge(receiver.get_rx_isr_profile());
+
+  sender.end(); receiver.end();
+}
+
+void print_profile(
+  const char* format,
+  const char* handler,
+  merged_profile& profile
+)
+{
+  printf(
+    "  %-22s %s: count %7u, mean %5u, 99.9%% <= %5u, max %8u " 
+      CYCLE_UNITS "\n",
+    format,
+    handler,
+    static_cast<unsigned>(profile.count),
+    static_cast<unsigned>(profile.get_mean()),
+    static_cast<unsigned>(profile.get_p999_bound()),
+    static_cast<unsigned>(profile.max)
+  );
+}
+
+void profile(
+  const char* name,
+  rx_decoder_codes the_rx_decoder,
+  tx_encoder_codes the_tx_encoder
+)
+{
+  uint32_t runtime_sender_pins[2]={10,11}, runtime_receiver_pins[2]={12,13};
+  uint32_t fixed_sender_pins[2]={22,23}, fixed_receiver_pins[2]={24,25};
+  merged_profile runtime_tc, runtime_rx, fixed_tc, fixed_rx;
+
+  // NOTE: the rounds are interleaved, so both formats see the same
+  // load of the host
+  for(uint32_t round=0; round<ROUNDS; round++)
+  {
+    profile_round(
+      serial_tc4,runtime_sender_pins,serial_tc5,runtime_receiver_pins,
+      the_rx_decoder,the_tx_encoder,runtime_tc,runtime_rx
+    );
+    profile_round(
+      serial_tc6,fixed_sender_pins,serial_tc8,fixed_receiver_pins,
+      the_rx_decoder,the_tx_encoder,fixed_tc,fixed_rx
+    );
+  }
+
+  printf("%s, %u frames received per format\n",name,ROUNDS*FRAMES);
+  print_profile("runtime_frame_format","TC",runtime_tc);
+  print_profile("frame_format_8E1","TC",fixed_tc);
+  print_profile("runtime_frame_format","RX",runtime_rx);
+  print_profile("frame_format_8E1","RX",fixed_rx);
+}
+
+int main()
+{
+  wire(11,12); wire(13,10);
+  wire(23,24); wire(25,22);
+
+  profile(
+    "8E1 OVERSAMPLING/PER_BIT",
+    rx_decoder_codes::OVERSAMPLING,tx_encoder_codes::PER_BIT
+  );
+  profile(
+    "8E1 EDGE_TIMESTAMPS/RUN_LENGTH",
+    rx_decoder_codes::EDGE_TIMESTAMPS,tx_encoder_codes::RUN_LENGTH
+  );
+
+  return 0;
+}
@@ -0,0 +1,312 @@
+/**
+ ** soft_uart library
+ ** Copyright (C) 2015-2020
+ **
+ **   Antonio C. Domínguez Brito <antonio.dominguez@ulpgc.es>
+ **     División de Robótica y Oceanografía Computacional <www.roc.siani.es>
+ **     and Departamento de Informática y Sistemas <www.dis.ulpgc.es>
+ **     Universidad de Las Palmas de Gran  Canaria (ULPGC) <www.ulpgc.es>
+ **  
+ ** This file is part of the soft_uart library.
+ ** The soft_uart library is free software: you can redistribute it and/or modify
+ ** it under  the  terms of  the GNU  General  Public  License  as  published  by
+ ** the  Free Software Foundation, either  version  3  of  the  License,  or  any
+ ** later version.
+ ** 
+ ** The  soft_uart library is distributed in the hope that  it  will  be  useful,
+ ** but   WITHOUT   ANY WARRANTY;   without   even   the  implied   warranty   of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR  PURPOSE.  See  the  GNU  General
+ ** Public License for more details.
+ ** 
+ ** You should have received a copy  (COPYING file) of  the  GNU  General  Public
+ ** License along with the soft_uart library.
+ ** If not, see: <http://www.gnu.org/licenses/>.
+ **/
+/*
+ * File: loopback_simulator.cpp 
+ * Description: This is an example illustrating the use of the soft_uart
+ * library on the host port (simulated peripherals). The TX pin of one
+ * uart object is wired to the RX pin of another one, with a given edge 
+ * latency on the wire, a clock skew between the TC channels of both and
+ * a (random) interrupt latency. For every framing and every pair of 
+ * transmission encoder and reception decoder, frames are streamed at the 
+ * standard bit rates to find the maximum bit rate received without errors.
+ *
+ * Usage: loopback_simulator [frames] [skew_ppm] [wire_latency_ns] 
+ *   [min_irq_latency_ns] [max_irq_latency_ns]
+ *
+ * NOTE: interrupt handlers run in zero simulated time, the interrupt 
+ * latency stands for both the entry to the handlers and the jitter of 
+ * the code they run.
+ *
+ * Date: October 17th, 2026
+ * Author: Antonio C. Dominguez-Brito <antonio.dominguez@ulpgc.es>
+ * ROC-SIANI - Universidad de Las Palmas de Gran Canaria - Spain
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "soft_uart.h"
+
+using namespace soft_uart;
+using namespace soft_uart::arduino_due;
+
+#define RX_BUF_LENGTH 256 
+#define TX_BUF_LENGTH 256 
+
+// NOTE: the sender transmits on pin 3 (TIOA7), and the receiver receives 
+// on pin 2 (TIOA0), so waveform transmission and input capture are 
+// available too
+#define SENDER_RX_PIN 23
+#define SENDER_TX_PIN 3
+#define RECEIVER_RX_PIN 2
+#define RECEIVER_TX_PIN 22
+
+typedef uart<timer_ids::TIMER_TC7,RX_BUF_LENGTH,TX_BUF_LENGTH> sender_t;
+typedef uart<timer_ids::TIMER_TC0,RX_BUF_LENGTH,TX_BUF_LENGTH> receiver_t;
+
+sender_t sender;
+receiver_t receiver;
+
+void TC7_Handler(void)
+{
+  sender_t::tc_interrupt(
+    TC_GetStatus(
+      tc_timer_table[static_cast<uint32_t>(timer_ids::TIMER_TC7)].tc_p,
+      tc_timer_table[static_cast<uint32_t>(timer_ids::TIMER_TC7)].channel
+    )
+  );
+}
+
+void TC0_Handler(void)
+{
+  receiver_t::tc_interrupt(
+    TC_GetStatus(
+      tc_timer_table[static_cast<uint32_t>(timer_ids::TIMER_TC0)].tc_p,
+      tc_timer_table[static_cast<uint32_t>(timer_ids::TIMER_TC0)].channel
+    )
+  );
+}
+
+struct framing
+{
+  const char* name;
+  data_bit_codes data_bits;
+  parity_codes parity;
+  stop_bit_codes stop_bits;
+};
+
+const framing framings[]=
+{
+  {
+    "8N1",
+    data_bit_codes::EIGHT_BITS,parity_codes::NO_PARITY,
+    stop_bit_codes::ONE_STOP_BIT
+  },
+  {
+    "8E1",
+    data_bit_codes::EIGHT_BITS,parity_codes::EVEN_PARITY,
+    stop_bit_codes::ONE_STOP_BIT
+  },
+  {
+    "7O2",
+    data_bit_codes::SEVEN_BITS,parity_codes::ODD_PARITY,
+    stop_bit_codes::TWO_STOP_BITS
+  },
+  {
+    "9N1",
+    data_bit_codes::NINE_BITS,parity_codes::NO_PARITY,
+    stop_bit_codes::ONE_STOP_BIT
+  },
+};
+
+struct engine
+{
+  const char* name;
+  tx_encoder_codes sender_tx_encoder;
+  rx_decoder_codes sender_rx_decoder;
+  rx_decoder_codes receiver_rx_decoder;
+  tx_encoder_codes receiver_tx_encoder;
+};
+
+// NOTE: oversampling reception goes with per bit transmission on the 
+// same object
+const engine engines[]=
+{
+  {
+    "PER_BIT->OVERSAMPLING",
+    tx_encoder_codes::PER_BIT,rx_decoder_codes::OVERSAMPLING,
+    rx_decoder_codes::OVERSAMPLING,tx_encoder_codes::PER_BIT
+  },
+  {
+    "RUN_LENGTH->EDGE_TIMESTAMPS",
+    tx_encoder_codes::RUN_LENGTH,rx_decoder_codes::EDGE_TIMESTAMPS,
+    rx_decoder_codes::EDGE_TIMESTAMPS,tx_encoder_codes::RUN_LENGTH
+  },
+  {
+    "WAVEFORM->INPUT_CAPTURE",
+    tx_encoder_codes::WAVEFORM,rx_decoder_codes::EDGE_TIMESTAMPS,
+    rx_decoder_codes::INPUT_CAPTURE,tx_encoder_codes::RUN_LENGTH
+  },
+};
+
+const uint32_t standard_bit_rates[]=
+{ 1200, 2400, 4800, 9600, 19200, 38400, 57600, 76800, 115200 };
+
+#define ELEMENTS(array) (sizeof(array)/sizeof(array[0]))
+
+struct simulation_parameters
+{
+  uint32_t frames;
+  int32_t skew_ppm;
+  host::sim_time wire_latency;
+  host::sim_time min_irq_latency;
+  host::sim_time max_irq_latency;
+};
+
+host::sim_time ns_to_sim_time(double ns)
+{ 
+  return static_cast<host::sim_time>(
+    ns*1e-9*(VARIANT_MCK/2)*double(host::SIM_TICK)
+  ); 
+}
+
+// NOTE: xorshift32, the receiver regenerates the sequence of the sender
+uint32_t next_data(uint32_t& seed,uint32_t mask)
+{
+  seed^=seed<<13; seed^=seed>>17; seed^=seed<<5;
+  return seed & mask;
+}
+
+// NOTE: it returns the number of frames not received or received with
+// errors, the stream is stopped on the first error
+uint32_t stream(
+  const simulation_parameters& parameters,
+  const framing& the_framing,
+  const engine& the_engine,
+  uint32_t bit_rate
+)
+{
+  host::reset();
+  host::connect_pins(SENDER_TX_PIN,RECEIVER_RX_PIN,parameters.wire_latency);
+  host::connect_pins(RECEIVER_TX_PIN,SENDER_RX_PIN,parameters.wire_latency);
+  host::set_tc_clock_ppm(
+    static_cast<uint32_t>(timer_ids::TIMER_TC7),parameters.skew_ppm
+  );
+  host::set_interrupt_latency(
+    parameters.min_irq_latency,parameters.max_irq_latency
+  );
+
+  if(
+    (
+      sender.config(
+        SENDER_RX_PIN,SENDER_TX_PIN,bit_rate,
+        the_framing.data_bits,the_framing.parity,the_framing.stop_bits,
+        the_engine.sender_rx_decoder,the_engine.sender_tx_encoder
+      )!=return_codes::EVERYTHING_OK
+    ) ||
+    (
+      receiver.config(
+        RECEIVER_RX_PIN,RECEIVER_TX_PIN,bit_rate,
+        the_framing.data_bits,the_framing.parity,the_framing.stop_bits,
+        the_engine.receiver_rx_decoder,the_engine.receiver_tx_encoder
+      )!=return_codes::EVERYTHING_OK
+    )
+  ) return parameters.frames;
+
+  uint32_t mask=(1u<<static_cast<uint32_t>(the_framing.data_bits))-1;
+  uint32_t tx_seed=0x12345678, rx_seed=0x12345678;
+  uint32_t tx_data=next_data(tx_seed,mask);
+  uint32_t sent=0, received=0, idle_chunks=0;
+
+  // NOTE: the simulation runs in chunks of a quarter of the buffers
+  uint32_t chunk_ticks=
+    (RX_BUF_LENGTH/4)*13*((VARIANT_MCK/2)/bit_rate);
+
+  while(received<parameters.frames)
+  {
+    while((sent<parameters.frames) && sender.set_tx_data(tx_data))
+    { sent++; tx_data=next_data(tx_seed,mask); }
+
+    host::run_for(chunk_ticks);
+
+    uint32_t data, status, before=received;
+    while(receiver.data_available(status=receiver.get_rx_data(data)))
+    {
+      if(
+        receiver.bad_status(status) || 
+        receiver.data_lost(status) ||
+        (data!=next_data(rx_seed,mask))
+      ) break;
+
+      received++;
+    }
+
+    if(receiver.data_available(status)) break;
+
+    // NOTE: frames lost on the wire
+    if(received==before) { if(++idle_chunks>4) break; }
+    else idle_chunks=0;
+  }
+
+  sender.end(); receiver.end();
+
+  return parameters.frames-received;
+}
+
+int main(int argc,char* argv[])
+{
+  simulation_parameters parameters;
+
+  parameters.frames=(argc>1)? strtoul(argv[1],nullptr,10): 10000;
+  parameters.skew_ppm=(argc>2)? strtol(argv[2],nullptr,10): 0;
+
+  double wire_latency_ns=(argc>3)? strtod(argv[3],nullptr): 50;
+  double min_irq_latency_ns=(argc>4)? strtod(argv[4],nullptr): 143;
+  double max_irq_latency_ns=
+    (argc>5)? strtod(argv[5],nullptr): min_irq_latency_ns;
+
+  parameters.wire_latency=ns_to_sim_time(wire_latency_ns);
+  parameters.min_irq_latency=ns_to_sim_time(min_irq_latency_ns);
+  parameters.max_irq_latency=ns_to_sim_time(max_irq_latency_ns);
+
+  printf(
+    "%u frames per test, skew %d ppm, wire latency %.0f ns, "
+    "interrupt latency %.0f-%.0f ns\n",
+    static_cast<unsigned>(parameters.frames),
+    static_cast<int>(parameters.skew_ppm),
+    wire_latency_ns,
+    min_irq_latency_ns,
+    max_irq_latency_ns
+  );
+
+  printf("%-7s %-28s","framing","engine");
+  for(uint32_t r=0; r<ELEMENTS(standard_bit_rates); r++) 
+    printf(" %7u",static_cast<unsigned>(standard_bit_rates[r]));
+  printf("  max. reliable\n");
+
+  for(uint32_t f=0; f<ELEMENTS(framings); f++)
+    for(uint32_t e=0; e<ELEMENTS(engines); e++)
+    {
+      printf("%-7s %-28s",framings[f].name,engines[e].name);
+
+      uint32_t max_bit_rate=0;
+      bool reliable=true;
+      for(uint32_t r=0; r<ELEMENTS(standard_bit_rates); r++)
+      {
+        uint32_t errors=
+          stream(parameters,framings[f],engines[e],standard_bit_rates[r]);
+
+        printf(" %7s",(errors)? "FAIL": "ok");
+        fflush(stdout);
+
+        if(errors) reliable=false;
+        else if(reliable) max_bit_rate=standard_bit_rates[r];
+      }
+
+      printf("  %u\n",static_cast<unsigned>(max_bit_rate));
+    }
+
+  return 0;
+}
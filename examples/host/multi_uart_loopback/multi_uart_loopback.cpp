@@ -0,0 +1,298 @@
+/**
+ ** soft_uart library
+ ** Copyright (C) 2015-2020
+ **
+ **   Antonio C. Domínguez Brito <antonio.dominguez@ulpgc.es>
+ **     División de Robótica y Oceanografía Computacional <www.roc.siani.es>
+ **     and Departamento de Informática y Sistemas <www.dis.ulpgc.es>
+ **     Universidad de Las Palmas de Gran  Canaria (ULPGC) <www.ulpgc.es>
+ **
+ ** This file is part of the soft_uart library.
+ ** The soft_uart library is free software: you can redistribute it and/or modify
+ ** it under  the  terms of  the GNU  General  Public  License  as  published  by
+ ** the  Free Software Foundation, either  version  3  of  the  License,  or  any
+ ** later version.
+ **
+ ** The  soft_uart library is distributed in the hope that  it  will  be  useful,
+ ** but   WITHOUT   ANY WARRANTY;   without   even   the  implied   warranty   of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR  PURPOSE.  See  the  GNU  General
+ ** Public License for more details.
+ **
+ ** You should have received a copy  (COPYING file) of  the  GNU  General  Public
+ ** License along with the soft_uart library.
+ ** If not, see: <http://www.gnu.org/licenses/>.
+ **/
+/*
+ * File: multi_uart_loopback.cpp
+ * Description: This is an example illustrating the use of the multi-port
+ * engines of the soft_uart library on the host port (simulated peripherals).
+ * Four TX ports (pins 33, 34, 35 and 36) sharing TC5 are wired to four RX
+ * ports (pins 37, 38, 39 and 40) sharing TC3, as in the multi_uart_test
+ * sketch. Every port streams a different sequence of data at the same time,
+ * and the frames, their statuses and the link statistics of each port are
+ * checked, also with frames lost on a full reception buffer and with frames
+ * of the wrong parity.
+ * Date: October 17th, 2026
+ * Author: Antonio C. Dominguez-Brito <antonio.dominguez@ulpgc.es>
+ * ROC-SIANI - Universidad de Las Palmas de Gran Canaria - Spain
+ */
+
+#include <cstdio>
+
+#include "multi_uart.h"
+
+using namespace soft_uart;
+using namespace soft_uart::arduino_due;
+
+#define RX_BUF_LENGTH 64 // reception buffer length of each port
+#define TX_BUF_LENGTH 64 // transmision buffer length of each port
+#define FRAMES 500 // frames sent on each port
+#define LOST_FRAMES 10
+
+multi_uart_rx_declaration(3,rx_ports,RX_BUF_LENGTH,37,38,39,40);
+multi_uart_tx_declaration(5,tx_ports,TX_BUF_LENGTH,33,34,35,36);
+
+const uint32_t tx_pins[]={ 33, 34, 35, 36 };
+const uint32_t rx_pins[]={ 37, 38, 39, 40 };
+
+static constexpr uint32_t PORTS=rx_ports_t::PORTS;
+
+// NOTE: a different sequence on each port
+uint32_t get_data(uint32_t port,uint32_t frame,uint32_t mask)
+{ return ((frame*(2*port+1))+(port*0x55)) & mask; }
+
+bool config(
+  uint32_t bit_rate,
+  data_bit_codes data_bits,
+  parity_codes rx_parity,
+  parity_codes tx_parity,
+  stop_bit_codes stop_bits
+)
+{
+  return (
+    (
+      rx_ports.config(bit_rate,data_bits,rx_parity,stop_bits)==
+        return_codes::EVERYTHING_OK
+    ) &&
+    (
+      tx_ports.config(bit_rate,data_bits,tx_parity,stop_bits)==
+        return_codes::EVERYTHING_OK
+    )
+  );
+}
+
+// NOTE: all the ports stream at once, it returns the number of frames
+// not received, or received wrong, on any port
+uint32_t stream(
+  const char* name,
+  uint32_t bit_rate,
+  data_bit_codes data_bits,
+  parity_codes parity,
+  stop_bit_codes stop_bits
+)
+{
+  if(!config(bit_rate,data_bits,parity,parity,stop_bits))
+  { printf("%s: config failed\n",name); return FRAMES*PORTS; }
+
+  uint32_t mask=(1<<static_cast<uint32_t>(data_bits))-1;
+  uint32_t sent[PORTS]={}, received[PORTS]={}, errors=0;
+  uint32_t done=0;
+  uint32_t start=micros();
+
+  while(done<PORTS)
+  {
+    for(uint32_t port=0; port<PORTS; port++)
+      if(
+        (sent[port]<FRAMES) &&
+        tx_ports.set_tx_data(port,get_data(port,sent[port],mask))
+      ) sent[port]++;
+
+    for(uint32_t port=0; port<PORTS; port++)
+    {
+      uint32_t data;
+      uint32_t status;
+      while(
+        rx_ports.data_available(status=rx_ports.get_rx_data(port,data))
+      )
+      {
+        if(
+          rx_ports.data_lost(status) || rx_ports.bad_status(status) ||
+          (data!=get_data(port,received[port],mask))
+        ) errors++;
+
+        if(++received[port]==FRAMES) done++;
+      }
+    }
+
+    host::busy_wait();
+
+    // nothing more to receive
+    if(micros()-start>2000000) break;
+  }
+
+  tx_ports.flush();
+
+  for(uint32_t port=0; port<PORTS; port++)
+  {
+    link_statistics statistics=rx_ports.get_link_statistics(port);
+    if(
+      (received[port]!=FRAMES) ||
+      (statistics.frames_received!=FRAMES) ||
+      statistics.overruns ||
+      statistics.bad_start_bits ||
+      statistics.bad_parities ||
+      statistics.bad_stop_bits
+    ) errors++;
+  }
+
+  printf(
+    "%s: %u frames per port, received %u/%u/%u/%u, %u errors, %u us\n",
+    name,
+    static_cast<unsigned>(FRAMES),
+    static_cast<unsigned>(received[0]),
+    static_cast<unsigned>(received[1]),
+    static_cast<unsigned>(received[2]),
+    static_cast<unsigned>(received[3]),
+    static_cast<unsigned>(errors),
+    static_cast<unsigned>(micros()-start)
+  );
+
+  return errors;
+}
+
+// NOTE: port 1 sends more frames than its RX buffer holds, without
+// reading them, the oldest frames are lost and reported just once,
+// while the other ports are not affected
+uint32_t lost_frames()
+{
+  if(
+    !config(
+      57600,data_bit_codes::EIGHT_BITS,parity_codes::EVEN_PARITY,
+      parity_codes::EVEN_PARITY,stop_bit_codes::ONE_STOP_BIT
+    )
+  ) { printf("lost frames: config failed\n"); return 1; }
+
+  static constexpr uint32_t LOST_PORT=1;
+  uint32_t errors=0;
+
+  for(uint32_t frame=0; frame<RX_BUF_LENGTH+LOST_FRAMES; frame++)
+  {
+    while(!tx_ports.set_tx_data(LOST_PORT,get_data(LOST_PORT,frame,0xFF)))
+      host::busy_wait();
+    if(frame<PORTS-1)
+      tx_ports.set_tx_data(
+        (LOST_PORT+1+frame)%PORTS,
+        get_data((LOST_PORT+1+frame)%PORTS,0,0xFF)
+      );
+  }
+  tx_ports.flush();
+  delay(1);
+
+  for(uint32_t port=0; port<PORTS; port++)
+  {
+    uint32_t expected=(port==LOST_PORT)? RX_BUF_LENGTH: 1;
+    uint32_t first=(port==LOST_PORT)? LOST_FRAMES: 0;
+
+    if(rx_ports.available(port)!=static_cast<int>(expected)) errors++;
+
+    for(uint32_t frame=0; frame<expected; frame++)
+    {
+      uint32_t data;
+      uint32_t status=rx_ports.get_rx_data(port,data);
+
+      if(
+        (rx_ports.data_lost(status)!=((port==LOST_PORT) && !frame)) ||
+        rx_ports.bad_status(status) ||
+        (data!=get_data(port,first+frame,0xFF))
+      ) errors++;
+    }
+
+    link_statistics statistics=rx_ports.get_link_statistics(port);
+    if(
+      (statistics.frames_received!=((port==LOST_PORT)?
+        RX_BUF_LENGTH+LOST_FRAMES: 1)) ||
+      (statistics.overruns!=((port==LOST_PORT)? LOST_FRAMES: 0)) ||
+      (statistics.rx_high_water_mark!=expected)
+    ) errors++;
+  }
+
+  printf(
+    "lost frames: %u frames sent on port %u, %u errors\n",
+    static_cast<unsigned>(RX_BUF_LENGTH+LOST_FRAMES),
+    static_cast<unsigned>(LOST_PORT),
+    static_cast<unsigned>(errors)
+  );
+
+  return errors;
+}
+
+// NOTE: the TX ports send with odd parity to RX ports expecting even
+// parity, so every frame is received with its raw data on the status
+uint32_t bad_parities()
+{
+  if(
+    !config(
+      19200,data_bit_codes::EIGHT_BITS,parity_codes::EVEN_PARITY,
+      parity_codes::ODD_PARITY,stop_bit_codes::ONE_STOP_BIT
+    )
+  ) { printf("bad parities: config failed\n"); return 1; }
+
+  uint32_t errors=0;
+
+  for(uint32_t port=0; port<PORTS; port++)
+    tx_ports.set_tx_data(port,get_data(port,0,0xFF));
+  tx_ports.flush();
+  delay(1);
+
+  for(uint32_t port=0; port<PORTS; port++)
+  {
+    uint32_t data;
+    uint32_t status=rx_ports.get_rx_data(port,data);
+
+    if(
+      !rx_ports.data_available(status) ||
+      !rx_ports.bad_parity(status) ||
+      rx_ports.bad_start_bit(status) ||
+      rx_ports.bad_stop_bit(status) ||
+      (data!=get_data(port,0,0xFF)) ||
+      (((status>>17)&0xFF)!=data) ||
+      (rx_ports.get_link_statistics(port).bad_parities!=1)
+    ) errors++;
+  }
+
+  printf("bad parities: %u errors\n",static_cast<unsigned>(errors));
+
+  return errors;
+}
+
+int main()
+{
+  uint32_t failures=0;
+
+  for(uint32_t port=0; port<PORTS; port++)
+    host::connect_pins(tx_pins[port],rx_pins[port]);
+
+  failures+=stream(
+    "8E1 19200",19200,
+    data_bit_codes::EIGHT_BITS,parity_codes::EVEN_PARITY,
+    stop_bit_codes::ONE_STOP_BIT
+  );
+  failures+=stream(
+    "8N1 57600",57600,
+    data_bit_codes::EIGHT_BITS,parity_codes::NO_PARITY,
+    stop_bit_codes::ONE_STOP_BIT
+  );
+  failures+=stream(
+    "7O2 115200",115200,
+    data_bit_codes::SEVEN_BITS,parity_codes::ODD_PARITY,
+    stop_bit_codes::TWO_STOP_BITS
+  );
+  failures+=lost_frames();
+  failures+=bad_parities();
+
+  rx_ports.end(); tx_ports.end();
+
+  printf("%s\n",(failures)? "FAILED": "OK");
+
+  return (failures)? 1: 0;
+}
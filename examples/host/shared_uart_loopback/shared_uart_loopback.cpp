@@ -0,0 +1,342 @@
+/**
+ ** soft_uart library
+ ** Copyright (C) 2015-2020
+ **
+ **   Antonio C. Domínguez Brito <antonio.dominguez@ulpgc.es>
+ **     División de Robótica y Oceanografía Computacional <www.roc.siani.es>
+ **     and Departamento de Informática y Sistemas <www.dis.ulpgc.es>
+ **     Universidad de Las Palmas de Gran  Canaria (ULPGC) <www.ulpgc.es>
+ **
+ ** This file is part of the soft_uart library.
+ ** The soft_uart library is free software: you can redistribute it and/or modify
+ ** it under  the  terms of  the GNU  General  Public  License  as  published  by
+ ** the  Free Software Foundation, either  version  3  of  the  License,  or  any
+ ** later version.
+ **
+ ** The  soft_uart library is distributed in the hope that  it  will  be  useful,
+ ** but   WITHOUT   ANY WARRANTY;   without   even   the  implied   warranty   of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR  PURPOSE.  See  the  GNU  General
+ ** Public License for more details.
+ **
+ ** You should have received a copy  (COPYING file) of  the  GNU  General  Public
+ ** License along with the soft_uart library.
+ ** If not, see: <http://www.gnu.org/licenses/>.
+ **/
+/*
+ * File: shared_uart_loopback.cpp
+ * Description: This is an example illustrating the use of the ports of
+ * header shared_uart.h on the host port (simulated peripherals). Three
+ * pairs of ports, at 9600, 57600 and 115200 bps, and with different
+ * framings, share the TC6 channel through a scheduler, each port with its
+ * TX pin wired to the RX pin of the other port of its pair. All of them
+ * stream at the same time, with and without interrupt latency, and the
+ * frames received, their statuses and the link statistics are checked.
+ * The scheduler is also checked alone with probe ports: the order of the
+ * deadlines, their replacement and cancellation, and the deadlines
+ * already due when they are scheduled.
+ * Date: October 17th, 2026
+ * Author: Antonio C. Dominguez-Brito <antonio.dominguez@ulpgc.es>
+ * ROC-SIANI - Universidad de Las Palmas de Gran Canaria - Spain
+ */
+
+#include <cstdio>
+
+#include "shared_uart.h"
+
+using namespace soft_uart;
+using namespace soft_uart::arduino_due;
+
+#define RX_BUF_LENGTH 64
+#define TX_BUF_LENGTH 64
+#define FRAMES 200 // frames sent by each port
+#define PORTS 6
+
+// scheduler using TC6, for up to 8 ports
+shared_uart_scheduler_declaration(6,8);
+
+shared_uart<scheduler_tc6_t,RX_BUF_LENGTH,TX_BUF_LENGTH> ports[PORTS];
+
+// NOTE: port i is paired with port i^1
+struct port_setup
+{
+  uint32_t rx_pin;
+  uint32_t tx_pin;
+  uint32_t bit_rate;
+  data_bit_codes data_bits;
+  parity_codes parity;
+  stop_bit_codes stop_bits;
+};
+
+const port_setup port_setups[PORTS]=
+{
+  {
+    10,11,9600,
+    data_bit_codes::EIGHT_BITS,parity_codes::EVEN_PARITY,
+    stop_bit_codes::ONE_STOP_BIT
+  },
+  {
+    12,13,9600,
+    data_bit_codes::EIGHT_BITS,parity_codes::EVEN_PARITY,
+    stop_bit_codes::ONE_STOP_BIT
+  },
+  {
+    24,25,57600,
+    data_bit_codes::EIGHT_BITS,parity_codes::NO_PARITY,
+    stop_bit_codes::ONE_STOP_BIT
+  },
+  {
+    26,27,57600,
+    data_bit_codes::EIGHT_BITS,parity_codes::NO_PARITY,
+    stop_bit_codes::ONE_STOP_BIT
+  },
+  {
+    28,29,115200,
+    data_bit_codes::SEVEN_BITS,parity_codes::ODD_PARITY,
+    stop_bit_codes::TWO_STOP_BITS
+  },
+  {
+    30,31,115200,
+    data_bit_codes::SEVEN_BITS,parity_codes::ODD_PARITY,
+    stop_bit_codes::TWO_STOP_BITS
+  },
+};
+
+host::sim_time ns_to_sim_time(double ns)
+{
+  return static_cast<host::sim_time>(
+    ns*1e-9*(VARIANT_MCK/2)*double(host::SIM_TICK)
+  );
+}
+
+// NOTE: a different sequence on each port
+uint32_t get_data(uint32_t port,uint32_t frame,uint32_t mask)
+{ return ((frame*(2*port+1))+(port*0x55)) & mask; }
+
+uint32_t get_mask(uint32_t port)
+{ return (1<<static_cast<uint32_t>(port_setups[port].data_bits))-1; }
+
+// NOTE: all the ports stream at once, it returns the number of frames
+// not received, or received wrong, on any port
+uint32_t stream(const char* name)
+{
+  uint32_t errors=0;
+
+  for(uint32_t port=0; port<PORTS; port++)
+    if(
+      ports[port].config(
+        port_setups[port].rx_pin,port_setups[port].tx_pin,
+        port_setups[port].bit_rate,port_setups[port].data_bits,
+        port_setups[port].parity,port_setups[port].stop_bits
+      )!=return_codes::EVERYTHING_OK
+    ) { printf("%s: config failed\n",name); return FRAMES*PORTS; }
+
+  uint32_t sent[PORTS]={}, received[PORTS]={};
+  uint32_t done=0;
+  uint32_t start=micros();
+
+  while(done<PORTS)
+  {
+    for(uint32_t port=0; port<PORTS; port++)
+      if(
+        (sent[port]<FRAMES) &&
+        ports[port].set_tx_data(get_data(port,sent[port],get_mask(port)))
+      ) sent[port]++;
+
+    for(uint32_t port=0; port<PORTS; port++)
+    {
+      uint32_t data;
+      uint32_t status;
+      while(ports[port].data_available(status=ports[port].get_rx_data(data)))
+      {
+        // NOTE: the frames received come from the other port of the pair
+        if(
+          ports[port].bad_status(status) ||
+          (data!=get_data(port^1,received[port],get_mask(port)))
+        ) errors++;
+
+        if(++received[port]==FRAMES) done++;
+      }
+    }
+
+    host::busy_wait();
+
+    // nothing more to receive
+    if(micros()-start>2000000) break;
+  }
+
+  for(uint32_t port=0; port<PORTS; port++)
+  {
+    ports[port].flush();
+
+    link_statistics statistics=ports[port].get_link_statistics();
+    if(
+      (received[port]!=FRAMES) ||
+      (statistics.frames_sent!=FRAMES) ||
+      (statistics.frames_received!=FRAMES) ||
+      statistics.overruns ||
+      statistics.bad_start_bits ||
+      statistics.bad_parities ||
+      statistics.bad_stop_bits
+    ) errors++;
+  }
+
+  printf(
+    "%s: %u frames per port, received %u/%u/%u/%u/%u/%u, %u errors, %u us\n",
+    name,
+    static_cast<unsigned>(FRAMES),
+    static_cast<unsigned>(received[0]),
+    static_cast<unsigned>(received[1]),
+    static_cast<unsigned>(received[2]),
+    static_cast<unsigned>(received[3]),
+    static_cast<unsigned>(received[4]),
+    static_cast<unsigned>(received[5]),
+    static_cast<unsigned>(errors),
+    static_cast<unsigned>(micros()-start)
+  );
+
+  for(uint32_t port=0; port<PORTS; port++) ports[port].end();
+
+  return errors;
+}
+
+// NOTE: the deadlines served to the probes, in order
+struct probe_call
+{
+  int32_t slot;
+  deadline_kinds kind;
+  uint32_t counter;
+};
+
+probe_call probe_calls[16];
+uint32_t probe_called=0;
+
+struct probe: scheduled_port
+{
+  void rx_edge() override {}
+
+  void deadline(deadline_kinds kind) override
+  {
+    if(probe_called<16)
+    {
+      probe_calls[probe_called].slot=slot;
+      probe_calls[probe_called].kind=kind;
+      probe_calls[probe_called].counter=scheduler_tc6_t::get_counter();
+    }
+    probe_called++;
+  }
+
+  int32_t slot;
+};
+
+uint32_t scheduler_probes()
+{
+  static constexpr uint32_t PROBES=3;
+  probe probes[PROBES];
+  uint32_t errors=0;
+
+  for(uint32_t i=0; i<PROBES; i++)
+    probes[i].slot=scheduler_tc6_t::attach(&probes[i]);
+
+  // sorted insertion: the deadlines are served by their time, not by
+  // the order they were scheduled, and a deadline replaces the one of
+  // the same kind of the same port
+  uint32_t now;
+  uint32_t deadlines[4];
+  probe_called=0;
+  {
+    interrupt_guard guard;
+
+    now=scheduler_tc6_t::get_counter();
+    deadlines[0]=now+1000; deadlines[1]=now+2000;
+    deadlines[2]=now+2500; deadlines[3]=now+3000;
+
+    scheduler_tc6_t::schedule(
+      probes[0].slot,deadline_kinds::TX_DEADLINE,now+500
+    );
+    scheduler_tc6_t::schedule(
+      probes[0].slot,deadline_kinds::TX_DEADLINE,deadlines[3]
+    );
+    scheduler_tc6_t::schedule(
+      probes[1].slot,deadline_kinds::RX_DEADLINE,deadlines[0]
+    );
+    scheduler_tc6_t::schedule(
+      probes[2].slot,deadline_kinds::TX_DEADLINE,deadlines[1]
+    );
+    scheduler_tc6_t::schedule(
+      probes[1].slot,deadline_kinds::TX_DEADLINE,deadlines[2]
+    );
+    scheduler_tc6_t::schedule(
+      probes[2].slot,deadline_kinds::RX_DEADLINE,now+1500
+    );
+  }
+  scheduler_tc6_t::cancel(probes[2].slot,deadline_kinds::RX_DEADLINE);
+  host::run_for(4000);
+
+  const int32_t expected_slots[4]=
+  { probes[1].slot, probes[2].slot, probes[1].slot, probes[0].slot };
+  const deadline_kinds expected_kinds[4]=
+  {
+    deadline_kinds::RX_DEADLINE, deadline_kinds::TX_DEADLINE,
+    deadline_kinds::TX_DEADLINE, deadline_kinds::TX_DEADLINE
+  };
+
+  if(probe_called!=4) errors++;
+  else
+    for(uint32_t i=0; i<4; i++)
+      if(
+        (probe_calls[i].slot!=expected_slots[i]) ||
+        (probe_calls[i].kind!=expected_kinds[i]) ||
+        !scheduler_tc6_t::is_due(deadlines[i],probe_calls[i].counter) ||
+        // NOTE: without interrupt latency, right on the deadline
+        (probe_calls[i].counter-deadlines[i]>1)
+      ) errors++;
+
+  // NOTE: a deadline already gone by when it is scheduled would not be
+  // served until the counter wraps around, unless the TC interrupt is
+  // forced, then it is served as soon as interrupts are enabled
+  probe_called=0;
+  {
+    interrupt_guard guard;
+
+    scheduler_tc6_t::schedule(
+      probes[0].slot,
+      deadline_kinds::RX_DEADLINE,
+      scheduler_tc6_t::get_counter()-100
+    );
+  }
+  if((probe_called!=1) || (probe_calls[0].slot!=probes[0].slot)) errors++;
+
+  host::run_for(1000);
+  if(probe_called!=1) errors++;
+
+  printf(
+    "scheduler probes: %u probes, %u errors\n",
+    static_cast<unsigned>(PROBES),
+    static_cast<unsigned>(errors)
+  );
+
+  for(uint32_t i=0; i<PROBES; i++) scheduler_tc6_t::detach(probes[i].slot);
+
+  return errors;
+}
+
+int main()
+{
+  uint32_t failures=0;
+
+  failures+=scheduler_probes();
+
+  for(uint32_t port=0; port<PORTS; port++)
+    host::connect_pins(port_setups[port].tx_pin,port_setups[port^1].rx_pin);
+
+  failures+=stream("9600 8E1, 57600 8N1 and 115200 7O2");
+
+  host::set_interrupt_latency(ns_to_sim_time(100),ns_to_sim_time(2000));
+  failures+=stream(
+    "9600 8E1, 57600 8N1 and 115200 7O2, 0.1-2 us interrupt latency"
+  );
+
+  printf("%s\n",(failures)? "FAILED": "OK");
+
+  return (failures)? 1: 0;
+}
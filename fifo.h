@@ -39,8 +39,12 @@
 template<bool BOOL_VALUE>
 struct bool_to_type { static constexpr bool value=BOOL_VALUE; };
 
-template<typename T,size_t LENGTH,bool IS_CIRCULAR = false>
-class basic_fifo
+template<
+  typename T,
+  size_t LENGTH,
+  bool IS_CIRCULAR = false,
+  bool IS_POWER_OF_TWO = ((LENGTH&(LENGTH-1))==0)
+> class basic_fifo
 {
   public:
 
@@ -78,6 +82,23 @@ class basic_fifo
 
     void reset() { _items_=0; _first_=0; _last_=LENGTH-1; }
 
+    // NOTE: zero-copy access, the largest run of elements which can be 
+    // read in place (up to the end of the buffer) without popping them,
+    // and consume() pops the first n of them (it always succeeds, it 
+    // returns bool as the spsc fifos)
+    size_t peek_contiguous(const T*& elements)
+    {
+      elements=&_buffer_[_first_];
+      size_t run=LENGTH-_first_;
+      return (static_cast<size_t>(_items_)<run)? _items_: run;
+    }
+
+    bool consume(size_t n)
+    { 
+      _items_-=n; _first_=(_first_+n)%LENGTH; 
+      return true;
+    }
+
   private:
 
     T _buffer_[LENGTH];
@@ -116,10 +137,354 @@ class basic_fifo
     }
 };
 
+// NOTE: specialization for power of two lengths, the indices are 
+// free-running counters masked with LENGTH-1, so there are neither 
+// modulo operations (divisions), nor an items counter to update
+template<typename T,size_t LENGTH,bool IS_CIRCULAR>
+class basic_fifo<T,LENGTH,IS_CIRCULAR,true>
+{
+  public:
+
+    basic_fifo()
+    : 
+      _pushed_{0},
+      _popped_{0}
+    {}
+
+    ~basic_fifo() {}
+
+    bool push(const T& t)
+    { return _push_(t,bool_to_type<IS_CIRCULAR>()); }
+   
+    bool pop(T& t)
+    {
+      if(is_empty()) return false;
+
+      t=_buffer_[_popped_&_MASK_];
+      _popped_++;
+
+      return true;
+    }
+
+    bool is_empty() { return (_pushed_==_popped_); }
+
+    bool is_full() { return (items()==LENGTH); }
+
+    int items() { return static_cast<int>(_pushed_-_popped_); }
+
+    int available() { return LENGTH-items(); }
+
+    void reset() { _pushed_=_popped_=0; }
+
+    // NOTE: zero-copy access, see the general template
+    size_t peek_contiguous(const T*& elements)
+    {
+      size_t index=_popped_&_MASK_;
+      elements=&_buffer_[index];
+      size_t run=LENGTH-index;
+      size_t items=_pushed_-_popped_;
+      return (items<run)? items: run;
+    }
+
+    bool consume(size_t n) { _popped_+=n; return true; }
+
+  private:
+
+    static constexpr size_t _MASK_=LENGTH-1;
+
+    T _buffer_[LENGTH];
+    size_t _pushed_,_popped_;
+
+    // push implementation for a normal fifo
+    // when is full, we can not push any further element 
+    bool _push_(const T& t,bool_to_type<false>)
+    {
+      if(is_full()) return false;
+
+      _buffer_[_pushed_&_MASK_]=t;
+      _pushed_++;
+
+      return true;
+    }
+
+    // push implementation for a circular fifo
+    // when is full, we overwrite the first element 
+    bool _push_(const T& t,bool_to_type<true>)
+    {
+      bool full=is_full();
+      
+      if(full) _popped_++;  
+
+      _buffer_[_pushed_&_MASK_]=t;
+      _pushed_++;
+
+      return full;
+    }
+};
+
 template<typename T, size_t LENGTH>
 using fifo=basic_fifo<T,LENGTH,false>; 
 
 template<typename T, size_t LENGTH>
 using circular_fifo=basic_fifo<T,LENGTH,true>; 
 
+// NOTE: basic_spsc_fifo is a fifo for just one producer and just one 
+// consumer (for example, an interrupt handler and the main program), 
+// which may push and pop concurrently without disabling interrupts.
+// Each side only writes its own counter (_pushed_ or _popped_), which
+// count elements modulo _WRAP_ (a multiple of LENGTH, or just the 
+// unsigned wrap-around for power of two lengths, indexing then with
+// a mask instead of a modulo operation)
+// When circular, pushing on a full fifo overwrites the oldest element,
+// so the consumer skips the elements overwritten, and pops again when
+// the element it was reading is overwritten meanwhile (the producer 
+// must be an interrupt handler, so that it is never interrupted by 
+// the consumer in the middle of a push)
+template<typename T,size_t LENGTH,bool IS_CIRCULAR = false>
+class basic_spsc_fifo
+{
+  public:
+
+    basic_spsc_fifo()
+    : 
+      _pushed_{0},
+      _popped_{0}
+    {}
+
+    ~basic_spsc_fifo() {}
+
+    // producer side
+    // NOTE: it returns false if the element was not pushed because the
+    // fifo was full (not circular), or if it overwrote the oldest one 
+    // (circular)
+    bool push(const T& t)
+    { return _push_(t,bool_to_type<IS_CIRCULAR>()); }
+   
+    // consumer side
+    bool pop(T& t)
+    { return _pop_(t,bool_to_type<IS_CIRCULAR>()); }
+
+    // consumer side, it pops up to length elements at once, returning
+    // how many were popped
+    size_t pop(T* elements,size_t length)
+    { return _pop_(elements,length,bool_to_type<IS_CIRCULAR>()); }
+
+    bool is_empty() { return (items()==0); }
+
+    bool is_full() { return (items()==LENGTH); }
+
+    int items() 
+    { 
+      size_t items=_distance_(_pushed_,_popped_);
+      return static_cast<int>((items>LENGTH)? LENGTH: items); 
+    }
+
+    int available() { return LENGTH-items(); }
+
+    // consumer side, it discards all the elements
+    void reset() { _popped_=_pushed_; __sync_synchronize(); }
+
+    // consumer side, zero-copy access, the largest run of elements 
+    // which can be read in place (up to the end of the buffer) without
+    // popping them
+    size_t peek_contiguous(const T*& elements)
+    {
+      size_t popped=_popped_;
+      size_t pushed=_pushed_;
+      size_t items=_distance_(pushed,popped);
+
+      // skipping the elements overwritten
+      if(items>LENGTH) 
+      { _popped_=popped=_distance_(pushed,LENGTH); items=LENGTH; }
+
+      // the elements must be read after they are published
+      __sync_synchronize();
+
+      size_t index=_index_(popped);
+      elements=&_buffer_[index];
+      return (items<LENGTH-index)? items: LENGTH-index;
+    }
+
+    // consumer side, it pops the first n elements peeked, it returns 
+    // false if (circular) they could have been overwritten while being 
+    // read in place
+    bool consume(size_t n)
+    {
+      size_t popped=_popped_;
+
+      // the elements must be read before their slots are released
+      __sync_synchronize();
+      bool intact=(_distance_(_pushed_,popped)<=LENGTH);
+
+      popped+=n;
+      if(!_IS_POWER_OF_TWO_ && (popped>=_WRAP_)) popped-=_WRAP_;
+      _popped_=popped;
+
+      return intact;
+    }
+
+  private:
+
+    static constexpr bool _IS_POWER_OF_TWO_=((LENGTH&(LENGTH-1))==0);
+    static constexpr size_t _WRAP_=(size_t(0x80000000)/LENGTH)*LENGTH;
+
+    T _buffer_[LENGTH];
+    volatile size_t _pushed_,_popped_;
+
+    static size_t _index_(size_t count)
+    { return (_IS_POWER_OF_TWO_)? (count&(LENGTH-1)): (count%LENGTH); }
+
+    static size_t _next_(size_t count)
+    { 
+      return (_IS_POWER_OF_TWO_ || (count+1!=_WRAP_))? count+1: 0; 
+    }
+
+    static size_t _distance_(size_t to,size_t from)
+    { 
+      return (_IS_POWER_OF_TWO_ || (to>=from))? to-from: to+_WRAP_-from; 
+    }
+
+    // push implementation for a normal fifo
+    // when is full, we can not push any further element 
+    bool _push_(const T& t,bool_to_type<false>)
+    {
+      size_t pushed=_pushed_;
+      if(_distance_(pushed,_popped_)>=LENGTH) return false;
+
+      _buffer_[_index_(pushed)]=t;
+
+      // the element must be stored before it is published
+      __sync_synchronize();
+      _pushed_=_next_(pushed);
+
+      return true;
+    }
+
+    // push implementation for a circular fifo
+    // when is full, we overwrite the oldest element
+    bool _push_(const T& t,bool_to_type<true>)
+    {
+      size_t pushed=_pushed_;
+      bool full=(_distance_(pushed,_popped_)>=LENGTH);
+
+      _buffer_[_index_(pushed)]=t;
+
+      // the element must be stored before it is published
+      __sync_synchronize();
+      _pushed_=_next_(pushed);
+
+      return !full;
+    }
+
+    // pop implementation for a normal fifo
+    bool _pop_(T& t,bool_to_type<false>)
+    {
+      size_t popped=_popped_;
+      if(_pushed_==popped) return false;
+
+      // the element must be read after it is published
+      __sync_synchronize();
+      t=_buffer_[_index_(popped)];
+
+      // and before its slot is released
+      __sync_synchronize();
+      _popped_=_next_(popped);
+
+      return true;
+    }
+
+    // pop implementation for a circular fifo
+    bool _pop_(T& t,bool_to_type<true>)
+    {
+      size_t popped=_popped_;
+
+      while(true)
+      {
+        size_t pushed=_pushed_;
+        size_t items=_distance_(pushed,popped);
+        if(items==0) return false;
+
+        // skipping the elements overwritten
+        if(items>LENGTH) popped=_distance_(pushed,LENGTH);
+
+        __sync_synchronize();
+        t=_buffer_[_index_(popped)];
+        __sync_synchronize();
+
+        // NOTE: if the producer has gone past the element read, it 
+        // could have overwritten it while we were reading it
+        if(_distance_(_pushed_,popped)<=LENGTH) break;
+      }
+
+      _popped_=_next_(popped);
+
+      return true;
+    }
+
+    // bulk pop implementation for a normal fifo
+    size_t _pop_(T* elements,size_t length,bool_to_type<false>)
+    {
+      size_t popped=_popped_;
+      size_t items=_distance_(_pushed_,popped);
+      if(items<length) length=items;
+      if(!length) return 0;
+
+      __sync_synchronize();
+      for(size_t i=0; i<length; i++) 
+      { elements[i]=_buffer_[_index_(popped)]; popped=_next_(popped); }
+      __sync_synchronize();
+
+      _popped_=popped;
+
+      return length;
+    }
+
+    // bulk pop implementation for a circular fifo
+    size_t _pop_(T* elements,size_t length,bool_to_type<true>)
+    {
+      if(!length) return 0;
+
+      size_t popped=_popped_;
+
+      while(true)
+      {
+        size_t pushed=_pushed_;
+        size_t items=_distance_(pushed,popped);
+        if(items==0) return 0;
+
+        // skipping the elements overwritten
+        if(items>LENGTH) { popped=_distance_(pushed,LENGTH); items=LENGTH; }
+        if(items<length) length=items;
+
+        size_t next=popped;
+        __sync_synchronize();
+        for(size_t i=0; i<length; i++) 
+        { elements[i]=_buffer_[_index_(next)]; next=_next_(next); }
+        __sync_synchronize();
+
+        // NOTE: the first elements the producer has gone past could 
+        // have been overwritten while we were reading them, so they 
+        // are dropped (if all of them, we pop again)
+        size_t overwritten=_distance_(_pushed_,popped);
+        overwritten=(overwritten>LENGTH)? overwritten-LENGTH: 0;
+        if(overwritten<length)
+        {
+          for(size_t i=overwritten; i<length; i++) 
+            elements[i-overwritten]=elements[i];
+
+          _popped_=next;
+          return length-overwritten;
+        }
+
+        popped=next;
+      }
+    }
+};
+
+template<typename T, size_t LENGTH>
+using spsc_fifo=basic_spsc_fifo<T,LENGTH,false>; 
+
+template<typename T, size_t LENGTH>
+using circular_spsc_fifo=basic_spsc_fifo<T,LENGTH,true>; 
+
 #endif // FIFO_H
@@ -0,0 +1,939 @@
+/**
+ ** soft_uart library
+ ** Copyright (C) 2015-2020
+ **
+ **   Antonio C. Domínguez Brito <antonio.dominguez@ulpgc.es>
+ **     División de Robótica y Oceanografía Computacional <www.roc.siani.es>
+ **     and Departamento de Informática y Sistemas <www.dis.ulpgc.es>
+ **     Universidad de Las Palmas de Gran  Canaria (ULPGC) <www.ulpgc.es>
+ **  
+ ** This file is part of the soft_uart library.
+ ** The soft_uart library is free software: you can redistribute it and/or modify
+ ** it under  the  terms of  the GNU  General  Public  License  as  published  by
+ ** the  Free Software Foundation, either  version  3  of  the  License,  or  any
+ ** later version.
+ ** 
+ ** The  soft_uart library is distributed in the hope that  it  will  be  useful,
+ ** but   WITHOUT   ANY WARRANTY;   without   even   the  implied   warranty   of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR  PURPOSE.  See  the  GNU  General
+ ** Public License for more details.
+ ** 
+ ** You should have received a copy  (COPYING file) of  the  GNU  General  Public
+ ** License along with the soft_uart library.
+ ** If not, see: <http://www.gnu.org/licenses/>.
+ **/
+/*
+ * File: host_port.cpp
+ * Description: Simulated Arduino Due's Atmel ATSAM3X8E peripherals (TC, PIO
+ * and NVIC) with a virtual clock, for building and running the Arduino DUE
+ * port of the soft_uart library on a host workstation. (implementation file)
+ * Date: October 17th, 2026
+ * Author: Antonio C. Dominguez-Brito <antonio.dominguez@ulpgc.es>
+ * ROC-SIANI - Universidad de Las Palmas de Gran Canaria - Spain
+ */
+
+#ifdef SOFT_UART_HOST_PORT
+
+  #include <ctime>
+  #include <queue>
+  #include <vector>
+
+  #include "host_port.h"
+
+  extern "C"
+  {
+    void TC0_Handler(void) __attribute__((weak));
+    void TC1_Handler(void) __attribute__((weak));
+    void TC2_Handler(void) __attribute__((weak));
+    void TC3_Handler(void) __attribute__((weak));
+    void TC4_Handler(void) __attribute__((weak));
+    void TC5_Handler(void) __attribute__((weak));
+    void TC6_Handler(void) __attribute__((weak));
+    void TC7_Handler(void) __attribute__((weak));
+    void TC8_Handler(void) __attribute__((weak));
+  }
+
+  namespace
+  {
+
+    NVIC_Type nvic_registers;
+    Tc tc_modules[3];
+    Pio pio_controllers[soft_uart::host::PIO_CONTROLLERS];
+
+    soft_uart::host::sim_time sim_now;
+    bool primask;
+    bool in_interrupt;
+
+    struct tc_line { uint32_t pio; uint32_t mask; };
+
+    // NOTE: TIOA lines of the TC channels, TC3, TC4 and TC5 have them
+    // on PIOE, which is not available on the DUE
+    const tc_line tioa_lines[soft_uart::host::TC_CHANNELS]=
+    {
+      {1,(1u<<25)}, // TIOA0: PB25 (pin 2)
+      {0,(1u<<2)}, // TIOA1: PA2 (A7)
+      {0,(1u<<5)}, // TIOA2: PA5
+      {0,0},
+      {0,0},
+      {0,0},
+      {2,(1u<<25)}, // TIOA6: PC25 (pin 5)
+      {2,(1u<<28)}, // TIOA7: PC28 (pin 3)
+      {3,(1u<<7)}, // TIOA8: PD7 (pin 11)
+    };
+
+    void (*const tc_handlers[soft_uart::host::TC_CHANNELS])(void)=
+    {
+      TC0_Handler, TC1_Handler, TC2_Handler,
+      TC3_Handler, TC4_Handler, TC5_Handler,
+      TC6_Handler, TC7_Handler, TC8_Handler
+    };
+
+    void (*pio_callbacks[soft_uart::host::PIO_CONTROLLERS][32])(void);
+    uint32_t pio_callback_modes[soft_uart::host::PIO_CONTROLLERS][32];
+
+    soft_uart::host::pin_callback pin_callbacks[NUM_DIGITAL_PINS];
+
+    struct wire { uint32_t to_pin; soft_uart::host::sim_time latency; };
+    wire wires[NUM_DIGITAL_PINS];
+
+    struct event
+    {
+      soft_uart::host::sim_time time;
+      uint64_t order;
+      soft_uart::host::event_callback callback;
+      uint32_t arg_0;
+      uint32_t arg_1;
+
+      bool operator>(const event& other) const
+      {
+        return (
+          (time>other.time) || 
+          ((time==other.time) && (order>other.order))
+        );
+      }
+    };
+
+    std::priority_queue<event,std::vector<event>,std::greater<event> > 
+      events;
+    uint64_t events_scheduled;
+
+    // NOTE: time at which every pending interrupt can be taken
+    soft_uart::host::sim_time irq_ready[TC8_IRQn+1];
+    soft_uart::host::sim_time irq_min_latency;
+    soft_uart::host::sim_time irq_max_latency;
+    uint64_t irq_latency_seed;
+
+    soft_uart::host::sim_time get_irq_latency()
+    {
+      if(irq_max_latency<=irq_min_latency) return irq_min_latency;
+
+      // NOTE: xorshift64, deterministic between runs
+      irq_latency_seed^=irq_latency_seed<<13;
+      irq_latency_seed^=irq_latency_seed>>7;
+      irq_latency_seed^=irq_latency_seed<<17;
+
+      return (
+        irq_min_latency+
+          irq_latency_seed%(irq_max_latency-irq_min_latency+1)
+      );
+    }
+
+    soft_uart::host::tc_channel_model& tc_channel(uint32_t id)
+    { return tc_modules[id/3].TC_CHANNEL[id%3].model; }
+
+    void set_pending(uint32_t irq) 
+    { 
+      if(NVIC->ISPR[irq>>5] & (1u<<(irq&0x1F))) return;
+
+      NVIC->ISPR[irq>>5]|=(1u<<(irq&0x1F)); 
+      if(irq<=TC8_IRQn) irq_ready[irq]=sim_now+get_irq_latency();
+    }
+
+    bool is_enabled_and_pending(uint32_t irq)
+    {
+      return (
+        NVIC->ISER[irq>>5] & NVIC->ISPR[irq>>5] & (1u<<(irq&0x1F))
+      );
+    }
+
+    void drive_wire(uint32_t to_pin,uint32_t level)
+    { soft_uart::host::drive_pin(to_pin,level); }
+
+    soft_uart::host::sim_time get_next_event()
+    {
+      using namespace soft_uart::host;
+
+      sim_time next=(events.empty())? NEVER: events.top().time;
+
+      for(uint32_t channel=0; channel<TC_CHANNELS; channel++)
+      {
+        sim_time event=tc_channel(channel).get_next_event();
+        if(event<next) next=event;
+      }
+
+      for(uint32_t irq=PIOA_IRQn; irq<=TC8_IRQn; irq++)
+        if(
+          is_enabled_and_pending(irq) && 
+          (irq_ready[irq]>sim_now) && 
+          (irq_ready[irq]<next)
+        ) next=irq_ready[irq];
+
+      return next;
+    }
+
+    void pio_handler(uint32_t id)
+    {
+      Pio* pio=&pio_controllers[id];
+      uint32_t isr=pio->PIO_ISR;
+      isr&=pio->PIO_IMR;
+
+      while(isr)
+      {
+        uint32_t bit=__builtin_ctz(isr);
+        isr&=~(1u<<bit);
+
+        if(!pio_callbacks[id][bit]) continue;
+
+        uint32_t level=(pio->PIO_PDSR>>bit)&1;
+        if(
+          (pio_callback_modes[id][bit]==CHANGE) ||
+          ((pio_callback_modes[id][bit]==RISING) && level) ||
+          ((pio_callback_modes[id][bit]==FALLING) && !level)
+        ) pio_callbacks[id][bit]();
+      }
+    }
+
+    struct initializer { initializer() { soft_uart::host::reset(); } } 
+      the_initializer;
+
+  } // namespace
+
+  NVIC_Type* NVIC=&nvic_registers;
+
+  Tc* TC0=&tc_modules[0];
+  Tc* TC1=&tc_modules[1];
+  Tc* TC2=&tc_modules[2];
+
+  Pio* PIOA=&pio_controllers[0];
+  Pio* PIOB=&pio_controllers[1];
+  Pio* PIOC=&pio_controllers[2];
+  Pio* PIOD=&pio_controllers[3];
+
+  #define SOFT_UART_HOST_PIN(pio,bit,type,tc_channel) \
+    { \
+      &pio_controllers[pio], \
+      (1u<<(bit)), \
+      static_cast<uint32_t>(PIOA_IRQn+(pio)), \
+      (type), \
+      PIO_DEFAULT, \
+      0, \
+      (tc_channel) \
+    }
+
+  const PinDescription g_APinDescription[NUM_DIGITAL_PINS]=
+  {
+    SOFT_UART_HOST_PIN(0,8,PIO_PERIPH_A,NOT_ON_TIMER), // 0: PA8
+    SOFT_UART_HOST_PIN(0,9,PIO_PERIPH_A,NOT_ON_TIMER), // 1: PA9
+    SOFT_UART_HOST_PIN(1,25,PIO_PERIPH_B,TC0_CHA0), // 2: PB25
+    SOFT_UART_HOST_PIN(2,28,PIO_PERIPH_B,TC2_CHA7), // 3: PC28
+    SOFT_UART_HOST_PIN(2,26,PIO_PERIPH_B,TC2_CHB6), // 4: PC26
+    SOFT_UART_HOST_PIN(2,25,PIO_PERIPH_B,TC2_CHA6), // 5: PC25
+    SOFT_UART_HOST_PIN(2,24,PIO_PERIPH_B,NOT_ON_TIMER), // 6: PC24
+    SOFT_UART_HOST_PIN(2,23,PIO_PERIPH_B,NOT_ON_TIMER), // 7: PC23
+    SOFT_UART_HOST_PIN(2,22,PIO_PERIPH_B,NOT_ON_TIMER), // 8: PC22
+    SOFT_UART_HOST_PIN(2,21,PIO_PERIPH_B,NOT_ON_TIMER), // 9: PC21
+    SOFT_UART_HOST_PIN(2,29,PIO_PERIPH_B,TC2_CHB7), // 10: PC29
+    SOFT_UART_HOST_PIN(3,7,PIO_PERIPH_B,TC2_CHA8), // 11: PD7
+    SOFT_UART_HOST_PIN(3,8,PIO_PERIPH_B,TC2_CHB8), // 12: PD8
+    SOFT_UART_HOST_PIN(1,27,PIO_PERIPH_B,TC0_CHB0), // 13: PB27
+    SOFT_UART_HOST_PIN(3,4,PIO_PERIPH_B,NOT_ON_TIMER), // 14: PD4
+    SOFT_UART_HOST_PIN(3,5,PIO_PERIPH_B,NOT_ON_TIMER), // 15: PD5
+    SOFT_UART_HOST_PIN(0,13,PIO_PERIPH_A,NOT_ON_TIMER), // 16: PA13
+    SOFT_UART_HOST_PIN(0,12,PIO_PERIPH_A,NOT_ON_TIMER), // 17: PA12
+    SOFT_UART_HOST_PIN(0,11,PIO_PERIPH_A,NOT_ON_TIMER), // 18: PA11
+    SOFT_UART_HOST_PIN(0,10,PIO_PERIPH_A,NOT_ON_TIMER), // 19: PA10
+    SOFT_UART_HOST_PIN(1,12,PIO_PERIPH_A,NOT_ON_TIMER), // 20: PB12
+    SOFT_UART_HOST_PIN(1,13,PIO_PERIPH_A,NOT_ON_TIMER), // 21: PB13
+    SOFT_UART_HOST_PIN(1,26,PIO_OUTPUT_0,NOT_ON_TIMER), // 22: PB26
+    SOFT_UART_HOST_PIN(0,14,PIO_OUTPUT_0,NOT_ON_TIMER), // 23: PA14
+    SOFT_UART_HOST_PIN(0,15,PIO_OUTPUT_0,NOT_ON_TIMER), // 24: PA15
+    SOFT_UART_HOST_PIN(3,0,PIO_OUTPUT_0,NOT_ON_TIMER), // 25: PD0
+    SOFT_UART_HOST_PIN(3,1,PIO_OUTPUT_0,NOT_ON_TIMER), // 26: PD1
+    SOFT_UART_HOST_PIN(3,2,PIO_OUTPUT_0,NOT_ON_TIMER), // 27: PD2
+    SOFT_UART_HOST_PIN(3,3,PIO_OUTPUT_0,NOT_ON_TIMER), // 28: PD3
+    SOFT_UART_HOST_PIN(3,6,PIO_OUTPUT_0,NOT_ON_TIMER), // 29: PD6
+    SOFT_UART_HOST_PIN(3,9,PIO_OUTPUT_0,NOT_ON_TIMER), // 30: PD9
+    SOFT_UART_HOST_PIN(0,7,PIO_OUTPUT_0,NOT_ON_TIMER), // 31: PA7
+    SOFT_UART_HOST_PIN(3,10,PIO_OUTPUT_0,NOT_ON_TIMER), // 32: PD10
+    SOFT_UART_HOST_PIN(2,1,PIO_OUTPUT_0,NOT_ON_TIMER), // 33: PC1
+    SOFT_UART_HOST_PIN(2,2,PIO_OUTPUT_0,NOT_ON_TIMER), // 34: PC2
+    SOFT_UART_HOST_PIN(2,3,PIO_OUTPUT_0,NOT_ON_TIMER), // 35: PC3
+    SOFT_UART_HOST_PIN(2,4,PIO_OUTPUT_0,NOT_ON_TIMER), // 36: PC4
+    SOFT_UART_HOST_PIN(2,5,PIO_OUTPUT_0,NOT_ON_TIMER), // 37: PC5
+    SOFT_UART_HOST_PIN(2,6,PIO_OUTPUT_0,NOT_ON_TIMER), // 38: PC6
+    SOFT_UART_HOST_PIN(2,7,PIO_OUTPUT_0,NOT_ON_TIMER), // 39: PC7
+    SOFT_UART_HOST_PIN(2,8,PIO_OUTPUT_0,NOT_ON_TIMER), // 40: PC8
+    SOFT_UART_HOST_PIN(2,9,PIO_OUTPUT_0,NOT_ON_TIMER), // 41: PC9
+    SOFT_UART_HOST_PIN(0,19,PIO_OUTPUT_0,NOT_ON_TIMER), // 42: PA19
+    SOFT_UART_HOST_PIN(0,20,PIO_OUTPUT_0,NOT_ON_TIMER), // 43: PA20
+    SOFT_UART_HOST_PIN(2,19,PIO_OUTPUT_0,NOT_ON_TIMER), // 44: PC19
+    SOFT_UART_HOST_PIN(2,18,PIO_OUTPUT_0,NOT_ON_TIMER), // 45: PC18
+    SOFT_UART_HOST_PIN(2,17,PIO_OUTPUT_0,NOT_ON_TIMER), // 46: PC17
+    SOFT_UART_HOST_PIN(2,16,PIO_OUTPUT_0,NOT_ON_TIMER), // 47: PC16
+    SOFT_UART_HOST_PIN(2,15,PIO_OUTPUT_0,NOT_ON_TIMER), // 48: PC15
+    SOFT_UART_HOST_PIN(2,14,PIO_OUTPUT_0,NOT_ON_TIMER), // 49: PC14
+    SOFT_UART_HOST_PIN(2,13,PIO_OUTPUT_0,NOT_ON_TIMER), // 50: PC13
+    SOFT_UART_HOST_PIN(2,12,PIO_OUTPUT_0,NOT_ON_TIMER), // 51: PC12
+    SOFT_UART_HOST_PIN(1,21,PIO_OUTPUT_0,NOT_ON_TIMER), // 52: PB21
+    SOFT_UART_HOST_PIN(1,14,PIO_OUTPUT_0,NOT_ON_TIMER), // 53: PB14
+  };
+
+  #undef SOFT_UART_HOST_PIN
+
+  TcChannel::TcChannel():
+    TC_CCR(&model), TC_CMR(&model), TC_CV(&model), TC_RA(&model),
+    TC_RB(&model), TC_RC(&model), TC_SR(&model), TC_IER(&model),
+    TC_IDR(&model), TC_IMR(&model)
+  {}
+
+  Pio::Pio():
+    PIO_PER(&model), PIO_PDR(&model), PIO_PSR(&model), PIO_OER(&model),
+    PIO_ODR(&model), PIO_OSR(&model), PIO_IER(&model), PIO_IDR(&model),
+    PIO_IMR(&model), PIO_ISR(&model), PIO_SODR(&model), PIO_CODR(&model),
+    PIO_ODSR(&model), PIO_PDSR(&model), PIO_OWER(&model), 
+    PIO_OWDR(&model), PIO_OWSR(&model)
+  {}
+
+  namespace soft_uart
+  {
+
+    namespace host
+    {
+
+      void tc_channel_model::reset(uint32_t the_id)
+      {
+        _id_=the_id;
+        _cmr_=_cv_=_ra_=_rb_=_rc_=_sr_=_imr_=_tioa_=0;
+        _clock_enabled_=_rb_next_=_rc_reset_=false;
+        _cv_time_=sim_now;
+        _tick_period_=SIM_TICK;
+      }
+
+      uint32_t tc_channel_model::read(uint32_t reg)
+      {
+        run_until(sim_now);
+
+        switch(reg)
+        {
+          case TC_CMR_REG: return _cmr_;
+          case TC_CV_REG: return _cv_;
+          case TC_RA_REG: return _ra_;
+          case TC_RB_REG: return _rb_;
+          case TC_RC_REG: return _rc_;
+          case TC_IMR_REG: return _imr_;
+
+          case TC_SR_REG:
+          {
+            // NOTE: the status flags are cleared when read
+            uint32_t status=_sr_|((_clock_enabled_)? TC_SR_CLKSTA: 0);
+            _sr_=0;
+            return status;
+          }
+        }
+
+        return 0;
+      }
+
+      void tc_channel_model::write(uint32_t reg,uint32_t value)
+      {
+        run_until(sim_now);
+
+        switch(reg)
+        {
+          case TC_CCR_REG:
+            if(value & TC_CCR_CLKDIS) _clock_enabled_=false;
+            else if(value & TC_CCR_CLKEN) _clock_enabled_=true;
+
+            if((value & TC_CCR_SWTRG) && _clock_enabled_)
+            {
+              _cv_=0; _cv_time_=sim_now; _rb_next_=_rc_reset_=false;
+              if(is_waveform()) set_tioa((_cmr_ & TC_CMR_ASWTRG_Msk)>>22);
+            }
+            break;
+
+          case TC_CMR_REG: 
+            _cmr_=value; _rc_reset_=(_rc_reset_ && is_reset_on_rc());
+            drive_tioa(); 
+            break;
+          case TC_RA_REG: _ra_=value; break;
+          case TC_RB_REG: _rb_=value; break;
+          case TC_RC_REG: _rc_=value; break;
+          case TC_IER_REG: _imr_|=value; break;
+          case TC_IDR_REG: _imr_&=~value; break;
+        }
+
+        dispatch_interrupts();
+      }
+
+      sim_time tc_channel_model::get_next_event()
+      {
+        if(!_clock_enabled_) return NEVER;
+
+        // NOTE: when reset on RC compare, the counter goes from RC 
+        // to 0 on the next tick
+        uint32_t from=(_rc_reset_)? 0xFFFFFFFF: _cv_;
+
+        uint64_t ticks=static_cast<uint32_t>(_rc_-from);
+        if(!ticks) ticks=(uint64_t(1)<<32);
+
+        if(is_waveform())
+        {
+          uint64_t ra_ticks=static_cast<uint32_t>(_ra_-from);
+          if(!ra_ticks) ra_ticks=(uint64_t(1)<<32);
+          if(ra_ticks<ticks) ticks=ra_ticks;
+        }
+
+        return _cv_time_+ticks*_tick_period_;
+      }
+
+      void tc_channel_model::run_until(sim_time now)
+      {
+        if(!_clock_enabled_) { _cv_time_=now; return; }
+
+        sim_time ticks=(now-_cv_time_)/_tick_period_;
+        if(!ticks) return;
+
+        _cv_time_+=ticks*_tick_period_;
+
+        // NOTE: the simulation stops on every compare, so only the
+        // last counter value can match
+        if(_rc_reset_) _cv_=static_cast<uint32_t>(ticks-1);
+        else _cv_=_cv_+static_cast<uint32_t>(ticks);
+
+        _rc_reset_=(is_reset_on_rc() && (_cv_==_rc_));
+        if(_cv_==_rc_) _sr_|=TC_SR_CPCS;
+
+        if(is_waveform() && (_cv_==_ra_))
+        {
+          _sr_|=TC_SR_CPAS;
+          set_tioa((_cmr_ & TC_CMR_ACPA_Msk)>>16);
+        }
+      }
+
+      void tc_channel_model::tioa_edge(uint32_t level)
+      {
+        if(is_waveform()) return;
+
+        run_until(sim_now);
+
+        uint32_t edge=(level)? 1: 2; // 1: rising, 2: falling
+
+        if(!_rb_next_ && (((_cmr_ & TC_CMR_LDRA_Msk)>>16) & edge))
+        { _ra_=_cv_; _sr_|=TC_SR_LDRAS; _rb_next_=true; }
+        else if(_rb_next_ && (((_cmr_ & TC_CMR_LDRB_Msk)>>18) & edge))
+        { _rb_=_cv_; _sr_|=TC_SR_LDRBS; _rb_next_=false; }
+      }
+
+      void tc_channel_model::set_tioa(uint32_t action)
+      {
+        switch(action)
+        {
+          case 1: _tioa_=1; break;
+          case 2: _tioa_=0; break;
+          case 3: _tioa_^=1; break;
+          default: return;
+        }
+
+        drive_tioa();
+      }
+
+      void tc_channel_model::drive_tioa()
+      {
+        const tc_line& line=tioa_lines[_id_];
+        if(!line.mask) return;
+
+        pio_controllers[line.pio].model.peripheral_drive(
+          line.mask,
+          is_waveform(),
+          (_tioa_)? line.mask: 0
+        );
+      }
+
+      void pio_model::reset(uint32_t the_id)
+      {
+        _id_=the_id;
+        _psr_=0xFFFFFFFF;
+        _osr_=_owsr_=_imr_=_isr_=0;
+
+        // NOTE: the lines are idle high, so configuring a TX pin as
+        // output does not glitch it
+        _odsr_=0xFFFFFFFF;
+
+        _external_driven_=_external_levels_=0;
+        _peripheral_driven_=_peripheral_levels_=0;
+        _pdsr_=0xFFFFFFFF;
+      }
+
+      uint32_t pio_model::read(uint32_t reg)
+      {
+        switch(reg)
+        {
+          case PIO_PSR_REG: return _psr_;
+          case PIO_OSR_REG: return _osr_;
+          case PIO_IMR_REG: return _imr_;
+          case PIO_ODSR_REG: return _odsr_;
+          case PIO_PDSR_REG: return _pdsr_;
+          case PIO_OWSR_REG: return _owsr_;
+
+          case PIO_ISR_REG:
+          {
+            // NOTE: the input changes are cleared when read
+            uint32_t status=_isr_;
+            _isr_=0;
+            return status;
+          }
+        }
+
+        return 0;
+      }
+
+      void pio_model::write(uint32_t reg,uint32_t value)
+      {
+        switch(reg)
+        {
+          case PIO_PER_REG: _psr_|=value; break;
+          case PIO_PDR_REG: _psr_&=~value; break;
+          case PIO_OER_REG: _osr_|=value; break;
+          case PIO_ODR_REG: _osr_&=~value; break;
+          case PIO_IER_REG: _imr_|=value; break;
+          case PIO_IDR_REG: _imr_&=~value; break;
+          case PIO_SODR_REG: _odsr_|=value; break;
+          case PIO_CODR_REG: _odsr_&=~value; break;
+          case PIO_ODSR_REG: 
+            _odsr_=(_odsr_ & ~_owsr_)|(value & _owsr_); 
+            break;
+          case PIO_OWER_REG: _owsr_|=value; break;
+          case PIO_OWDR_REG: _owsr_&=~value; break;
+        }
+
+        update();
+        dispatch_interrupts();
+      }
+
+      void pio_model::configure(EPioType type,uint32_t mask)
+      {
+        switch(type)
+        {
+          case PIO_PERIPH_A:
+          case PIO_PERIPH_B:
+          case PIO_PERIPH_C:
+          case PIO_PERIPH_D:
+            _psr_&=~mask;
+            break;
+
+          case PIO_INPUT:
+            _osr_&=~mask; _psr_|=mask;
+            break;
+
+          case PIO_OUTPUT_0:
+          case PIO_OUTPUT_1:
+            if(type==PIO_OUTPUT_1) _odsr_|=mask;
+            else _odsr_&=~mask;
+            _osr_|=mask; _psr_|=mask;
+            break;
+
+          default: return;
+        }
+
+        update();
+        dispatch_interrupts();
+      }
+
+      void pio_model::drive(uint32_t mask,uint32_t levels)
+      {
+        _external_driven_|=mask;
+        _external_levels_=(_external_levels_ & ~mask)|(levels & mask);
+        update();
+        dispatch_interrupts();
+      }
+
+      void pio_model::release(uint32_t mask)
+      {
+        _external_driven_&=~mask;
+        update();
+        dispatch_interrupts();
+      }
+
+      void pio_model::peripheral_drive(
+        uint32_t mask,
+        bool driving,
+        uint32_t levels
+      )
+      {
+        if(driving) _peripheral_driven_|=mask;
+        else _peripheral_driven_&=~mask;
+        _peripheral_levels_=(_peripheral_levels_ & ~mask)|(levels & mask);
+        update();
+      }
+
+      void pio_model::update()
+      {
+        uint32_t pio_outputs=_psr_ & _osr_;
+        uint32_t peripheral_outputs=~_psr_ & _peripheral_driven_;
+        uint32_t inputs=~(pio_outputs|peripheral_outputs);
+
+        // NOTE: lines not driven at all are pulled up
+        uint32_t levels=
+          (pio_outputs & _odsr_) |
+          (peripheral_outputs & _peripheral_levels_) |
+          (
+            inputs & 
+            ((_external_driven_ & _external_levels_)|~_external_driven_)
+          );
+
+        uint32_t changes=levels ^ _pdsr_;
+        if(!changes) return;
+
+        _pdsr_=levels;
+        _isr_|=changes;
+
+        // TIOA lines handed over to TC channels in capture mode
+        for(uint32_t channel=0; channel<TC_CHANNELS; channel++)
+          if(
+            (tioa_lines[channel].pio==_id_) &&
+            (tioa_lines[channel].mask & changes & ~_psr_)
+          ) 
+            tc_channel(channel).tioa_edge(
+              (levels & tioa_lines[channel].mask)? 1: 0
+            );
+
+        for(uint32_t pin=0; pin<NUM_DIGITAL_PINS; pin++)
+          if(
+            pin_callbacks[pin] &&
+            (g_APinDescription[pin].pPort==&pio_controllers[_id_]) &&
+            (g_APinDescription[pin].ulPin & changes)
+          ) 
+            pin_callbacks[pin](
+              pin,
+              (levels & g_APinDescription[pin].ulPin)? 1: 0
+            );
+
+        for(uint32_t pin=0; pin<NUM_DIGITAL_PINS; pin++)
+          if(
+            (wires[pin].to_pin<NUM_DIGITAL_PINS) &&
+            (g_APinDescription[pin].pPort==&pio_controllers[_id_]) &&
+            (g_APinDescription[pin].ulPin & changes)
+          ) 
+            schedule_event(
+              sim_now+wires[pin].latency,
+              drive_wire,
+              wires[pin].to_pin,
+              (levels & g_APinDescription[pin].ulPin)? 1: 0
+            );
+      }
+
+      void reset()
+      {
+        for(uint32_t i=0; i<8; i++)
+          NVIC->ISER[i]=NVIC->ICER[i]=NVIC->ISPR[i]=NVIC->ICPR[i]=0;
+
+        sim_now=0; primask=false; in_interrupt=false;
+
+        while(!events.empty()) events.pop();
+        events_scheduled=0;
+
+        for(uint32_t irq=0; irq<=TC8_IRQn; irq++) irq_ready[irq]=0;
+        irq_min_latency=irq_max_latency=0;
+        irq_latency_seed=0x9E3779B97F4A7C15ull;
+
+        for(uint32_t channel=0; channel<TC_CHANNELS; channel++)
+          tc_channel(channel).reset(channel);
+
+        for(uint32_t id=0; id<PIO_CONTROLLERS; id++)
+        {
+          pio_controllers[id].model.reset(id);
+          for(uint32_t bit=0; bit<32; bit++) 
+          { pio_callbacks[id][bit]=nullptr; pio_callback_modes[id][bit]=0; }
+        }
+
+        for(uint32_t pin=0; pin<NUM_DIGITAL_PINS; pin++)
+        { pin_callbacks[pin]=nullptr; wires[pin].to_pin=NUM_DIGITAL_PINS; }
+
+        // NOTE: the DUE core enables the PIO interrupts on start up
+        for(uint32_t id=0; id<PIO_CONTROLLERS; id++)
+          NVIC_EnableIRQ(static_cast<IRQn_Type>(PIOA_IRQn+id));
+      }
+
+      sim_time get_time() { return sim_now; }
+
+      void run_until(sim_time the_time)
+      {
+        for(;;)
+        {
+          sim_time next=get_next_event();
+          if(next>the_time) break;
+
+          sim_now=next;
+          for(uint32_t channel=0; channel<TC_CHANNELS; channel++)
+            tc_channel(channel).run_until(sim_now);
+
+          while(!events.empty() && (events.top().time<=sim_now))
+          {
+            event the_event=events.top(); events.pop();
+            the_event.callback(the_event.arg_0,the_event.arg_1);
+          }
+
+          dispatch_interrupts();
+        }
+
+        if(the_time>sim_now) sim_now=the_time;
+      }
+
+      void run_for(uint32_t ticks) { run_until(sim_now+ticks*SIM_TICK); }
+
+      void busy_wait()
+      {
+        sim_time next=get_next_event();
+        run_until((next!=NEVER)? next: sim_now+SIM_TICK);
+      }
+
+      uint32_t get_pin_level(uint32_t pin)
+      {
+        return (
+          (
+            g_APinDescription[pin].pPort->model.get_levels() & 
+            g_APinDescription[pin].ulPin
+          )? 1: 0
+        );
+      }
+
+      void drive_pin(uint32_t pin,uint32_t level)
+      {
+        g_APinDescription[pin].pPort->model.drive(
+          g_APinDescription[pin].ulPin,
+          (level)? g_APinDescription[pin].ulPin: 0
+        );
+      }
+
+      void release_pin(uint32_t pin)
+      { 
+        g_APinDescription[pin].pPort->model.release(
+          g_APinDescription[pin].ulPin
+        ); 
+      }
+
+      void on_pin_change(uint32_t pin,pin_callback callback)
+      { pin_callbacks[pin]=callback; }
+
+      void set_tc_clock_ppm(uint32_t channel,int32_t ppm)
+      {
+        tc_channel(channel).run_until(sim_now);
+        tc_channel(channel).set_clock_period(
+          SIM_TICK+(static_cast<int64_t>(SIM_TICK)*ppm)/1000000
+        );
+      }
+
+      void connect_pins(uint32_t from_pin,uint32_t to_pin,sim_time latency)
+      {
+        wires[from_pin].to_pin=to_pin;
+        wires[from_pin].latency=latency;
+
+        drive_pin(to_pin,get_pin_level(from_pin));
+      }
+
+      void disconnect_pin(uint32_t from_pin)
+      { wires[from_pin].to_pin=NUM_DIGITAL_PINS; }
+
+      void schedule_event(
+        sim_time the_time,
+        event_callback callback,
+        uint32_t arg_0,
+        uint32_t arg_1
+      )
+      {
+        event the_event=
+          { the_time, events_scheduled++, callback, arg_0, arg_1 };
+        events.push(the_event);
+      }
+
+      void set_interrupt_latency(sim_time min_latency,sim_time max_latency)
+      {
+        irq_min_latency=min_latency;
+        irq_max_latency=(max_latency>min_latency)? max_latency: min_latency;
+      }
+
+      uint32_t cycle_source::get_cycles()
+      {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC,&now);
+
+        return static_cast<uint32_t>(
+          static_cast<uint64_t>(now.tv_sec)*1000000000ull+now.tv_nsec
+        );
+      }
+
+      void dispatch_interrupts()
+      {
+        if(primask || in_interrupt) return;
+
+        for(;;)
+        {
+          // NOTE: the peripheral interrupt lines are level sensitive
+          for(uint32_t channel=0; channel<TC_CHANNELS; channel++)
+            if(tc_channel(channel).is_irq_asserted()) 
+              set_pending(TC0_IRQn+channel);
+
+          for(uint32_t id=0; id<PIO_CONTROLLERS; id++)
+            if(pio_controllers[id].model.is_irq_asserted()) 
+              set_pending(PIOA_IRQn+id);
+
+          uint32_t irq=PIOA_IRQn;
+          while(
+            (irq<=TC8_IRQn) && 
+            (!is_enabled_and_pending(irq) || (irq_ready[irq]>sim_now))
+          ) irq++;
+          if(irq>TC8_IRQn) return;
+
+          NVIC_ClearPendingIRQ(static_cast<IRQn_Type>(irq));
+
+          in_interrupt=true;
+          if(irq>=TC0_IRQn)
+          {
+            if(tc_handlers[irq-TC0_IRQn]) tc_handlers[irq-TC0_IRQn]();
+            // NOTE: without handler the interrupt would never end
+            else NVIC_DisableIRQ(static_cast<IRQn_Type>(irq));
+          }
+          else if(irq<=PIOD_IRQn) pio_handler(irq-PIOA_IRQn);
+          in_interrupt=false;
+        }
+      }
+
+    } // namespace host
+
+  } // namespace soft_uart
+
+  void NVIC_EnableIRQ(IRQn_Type irq)
+  { 
+    NVIC->ISER[irq>>5]|=(1u<<(irq&0x1F)); 
+    soft_uart::host::dispatch_interrupts();
+  }
+
+  void NVIC_DisableIRQ(IRQn_Type irq) 
+  { NVIC->ISER[irq>>5]&=~(1u<<(irq&0x1F)); }
+
+  void NVIC_SetPendingIRQ(IRQn_Type irq)
+  {
+    set_pending(irq); 
+    soft_uart::host::dispatch_interrupts();
+  }
+
+  void NVIC_ClearPendingIRQ(IRQn_Type irq)
+  { NVIC->ISPR[irq>>5]&=~(1u<<(irq&0x1F)); }
+
+  uint32_t NVIC_GetPendingIRQ(IRQn_Type irq)
+  { return (NVIC->ISPR[irq>>5] & (1u<<(irq&0x1F)))? 1: 0; }
+
+  void __disable_irq() { primask=true; }
+
+  void __enable_irq() 
+  { 
+    primask=false; 
+    soft_uart::host::dispatch_interrupts(); 
+  }
+
+  uint32_t PIO_Configure(
+    Pio* pio,
+    const EPioType type,
+    const uint32_t mask,
+    const uint32_t // attribute, pull-ups are not simulated
+  )
+  {
+    pio->model.configure(type,mask);
+    return 1;
+  }
+
+  void pinMode(uint32_t pin,uint32_t mode)
+  {
+    Pio* pio=g_APinDescription[pin].pPort;
+    uint32_t mask=g_APinDescription[pin].ulPin;
+
+    if(mode==OUTPUT)
+      // NOTE: the line keeps the level it had on PIO_ODSR
+      PIO_Configure(
+        pio,
+        (pio->PIO_ODSR & mask)? PIO_OUTPUT_1: PIO_OUTPUT_0,
+        mask,
+        PIO_DEFAULT
+      );
+    else 
+      PIO_Configure(
+        pio,
+        PIO_INPUT,
+        mask,
+        (mode==INPUT_PULLUP)? PIO_PULLUP: PIO_DEFAULT
+      );
+  }
+
+  void digitalWrite(uint32_t pin,uint32_t level)
+  {
+    if(level) PIO_Set(g_APinDescription[pin].pPort,g_APinDescription[pin].ulPin);
+    else PIO_Clear(g_APinDescription[pin].pPort,g_APinDescription[pin].ulPin);
+  }
+
+  int digitalRead(uint32_t pin)
+  {
+    return PIO_Get(
+      g_APinDescription[pin].pPort,
+      PIO_INPUT,
+      g_APinDescription[pin].ulPin
+    );
+  }
+
+  void attachInterrupt(uint32_t pin,void (*callback)(void),uint32_t mode)
+  {
+    Pio* pio=g_APinDescription[pin].pPort;
+    uint32_t id=pio->model.get_id();
+    uint32_t bit=__builtin_ctz(g_APinDescription[pin].ulPin);
+
+    pio_callbacks[id][bit]=callback;
+    pio_callback_modes[id][bit]=mode;
+
+    pio->PIO_IER=g_APinDescription[pin].ulPin;
+  }
+
+  void detachInterrupt(uint32_t pin)
+  { g_APinDescription[pin].pPort->PIO_IDR=g_APinDescription[pin].ulPin; }
+
+  uint32_t micros()
+  {
+    return static_cast<uint32_t>(
+      (sim_now>>soft_uart::host::SIM_TIME_BITS)/((VARIANT_MCK/2)/1000000)
+    );
+  }
+
+  uint32_t millis()
+  {
+    return static_cast<uint32_t>(
+      (sim_now>>soft_uart::host::SIM_TIME_BITS)/((VARIANT_MCK/2)/1000)
+    );
+  }
+
+  void delay(uint32_t ms)
+  { 
+    soft_uart::host::run_until(
+      sim_now+
+        static_cast<soft_uart::host::sim_time>(ms)*
+          ((VARIANT_MCK/2)/1000)*soft_uart::host::SIM_TICK
+    ); 
+  }
+
+  void delayMicroseconds(uint32_t us)
+  { 
+    soft_uart::host::run_until(
+      sim_now+
+        static_cast<soft_uart::host::sim_time>(us)*
+          ((VARIANT_MCK/2)/1000000)*soft_uart::host::SIM_TICK
+    ); 
+  }
+
+#endif // SOFT_UART_HOST_PORT
@@ -0,0 +1,601 @@
+/**
+ ** soft_uart library
+ ** Copyright (C) 2015-2020
+ **
+ **   Antonio C. Domínguez Brito <antonio.dominguez@ulpgc.es>
+ **     División de Robótica y Oceanografía Computacional <www.roc.siani.es>
+ **     and Departamento de Informática y Sistemas <www.dis.ulpgc.es>
+ **     Universidad de Las Palmas de Gran  Canaria (ULPGC) <www.ulpgc.es>
+ **  
+ ** This file is part of the soft_uart library.
+ ** The soft_uart library is free software: you can redistribute it and/or modify
+ ** it under  the  terms of  the GNU  General  Public  License  as  published  by
+ ** the  Free Software Foundation, either  version  3  of  the  License,  or  any
+ ** later version.
+ ** 
+ ** The  soft_uart library is distributed in the hope that  it  will  be  useful,
+ ** but   WITHOUT   ANY WARRANTY;   without   even   the  implied   warranty   of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR  PURPOSE.  See  the  GNU  General
+ ** Public License for more details.
+ ** 
+ ** You should have received a copy  (COPYING file) of  the  GNU  General  Public
+ ** License along with the soft_uart library.
+ ** If not, see: <http://www.gnu.org/licenses/>.
+ **/
+/*
+ * File: host_port.h
+ * Description: Simulated Arduino Due's Atmel ATSAM3X8E peripherals (TC, PIO
+ * and NVIC) with a virtual clock, for building and running the Arduino DUE
+ * port of the soft_uart library on a host workstation.
+ * Date: October 17th, 2026
+ * Author: Antonio C. Dominguez-Brito <antonio.dominguez@ulpgc.es>
+ * ROC-SIANI - Universidad de Las Palmas de Gran Canaria - Spain
+ */
+
+#ifndef HOST_PORT_H
+  #define HOST_PORT_H
+
+  #include <cstdint>
+  #include <cstddef>
+
+  // NOTE: this header replaces "Arduino.h" when SOFT_UART_HOST_PORT is 
+  // defined, it provides the subset of the Arduino DUE core and CMSIS
+  // used by the library, on top of models of the TC channels, the PIO
+  // controllers and the NVIC. Time only goes by when the simulation is
+  // run (soft_uart::host::run_for() and run_until()) or on the busy 
+  // waits of the library, and interrupt handlers take no time at all
+
+  #define __INLINE inline
+
+  #define VARIANT_MCK 84000000
+  #define NUM_DIGITAL_PINS 54
+
+  #define LOW 0
+  #define HIGH 1
+
+  #define INPUT 0
+  #define OUTPUT 1
+  #define INPUT_PULLUP 2
+
+  #define CHANGE 2
+  #define FALLING 3
+  #define RISING 4
+
+  typedef enum IRQn
+  {
+    PIOA_IRQn=11,
+    PIOB_IRQn=12,
+    PIOC_IRQn=13,
+    PIOD_IRQn=14,
+    TC0_IRQn=27,
+    TC1_IRQn=28,
+    TC2_IRQn=29,
+    TC3_IRQn=30,
+    TC4_IRQn=31,
+    TC5_IRQn=32,
+    TC6_IRQn=33,
+    TC7_IRQn=34,
+    TC8_IRQn=35
+  } IRQn_Type;
+
+  struct NVIC_Type 
+  { 
+    uint32_t ISER[8]; 
+    uint32_t ICER[8]; 
+    uint32_t ISPR[8]; 
+    uint32_t ICPR[8]; 
+  };
+
+  extern NVIC_Type* NVIC;
+
+  void NVIC_EnableIRQ(IRQn_Type irq);
+  void NVIC_DisableIRQ(IRQn_Type irq);
+  void NVIC_SetPendingIRQ(IRQn_Type irq);
+  void NVIC_ClearPendingIRQ(IRQn_Type irq);
+  uint32_t NVIC_GetPendingIRQ(IRQn_Type irq);
+  inline void NVIC_SetPriority(IRQn_Type,uint32_t) {}
+
+  void __disable_irq();
+  void __enable_irq();
+
+  // TC registers bits
+  #define TC_CCR_CLKEN (0x1u<<0)
+  #define TC_CCR_CLKDIS (0x1u<<1)
+  #define TC_CCR_SWTRG (0x1u<<2)
+
+  #define TC_CMR_TCCLKS_TIMER_CLOCK1 (0x0u<<0)
+  #define TC_CMR_CPCTRG (0x1u<<14)
+  #define TC_CMR_WAVE (0x1u<<15)
+  #define TC_CMR_WAVSEL_Msk (0x3u<<13)
+  #define TC_CMR_WAVSEL_UP (0x0u<<13)
+  #define TC_CMR_WAVSEL_UP_RC (0x2u<<13)
+  #define TC_CMR_LDRA_Msk (0x3u<<16)
+  #define TC_CMR_LDRA_RISING (0x1u<<16)
+  #define TC_CMR_LDRA_FALLING (0x2u<<16)
+  #define TC_CMR_LDRA_EDGE (0x3u<<16)
+  #define TC_CMR_LDRB_Msk (0x3u<<18)
+  #define TC_CMR_LDRB_RISING (0x1u<<18)
+  #define TC_CMR_LDRB_FALLING (0x2u<<18)
+  #define TC_CMR_LDRB_EDGE (0x3u<<18)
+  #define TC_CMR_ACPA_Msk (0x3u<<16)
+  #define TC_CMR_ACPA_SET (0x1u<<16)
+  #define TC_CMR_ACPA_CLEAR (0x2u<<16)
+  #define TC_CMR_ACPA_TOGGLE (0x3u<<16)
+  #define TC_CMR_ASWTRG_Msk (0x3u<<22)
+  #define TC_CMR_ASWTRG_SET (0x1u<<22)
+  #define TC_CMR_ASWTRG_CLEAR (0x2u<<22)
+  #define TC_CMR_ASWTRG_TOGGLE (0x3u<<22)
+
+  #define TC_SR_COVFS (0x1u<<0)
+  #define TC_SR_LOVRS (0x1u<<1)
+  #define TC_SR_CPAS (0x1u<<2)
+  #define TC_SR_CPBS (0x1u<<3)
+  #define TC_SR_CPCS (0x1u<<4)
+  #define TC_SR_LDRAS (0x1u<<5)
+  #define TC_SR_LDRBS (0x1u<<6)
+  #define TC_SR_CLKSTA (0x1u<<16)
+
+  #define TC_IER_CPAS TC_SR_CPAS
+  #define TC_IER_CPCS TC_SR_CPCS
+  #define TC_IER_LDRAS TC_SR_LDRAS
+  #define TC_IER_LDRBS TC_SR_LDRBS
+  #define TC_IDR_CPAS TC_SR_CPAS
+  #define TC_IDR_CPCS TC_SR_CPCS
+  #define TC_IDR_LDRAS TC_SR_LDRAS
+  #define TC_IDR_LDRBS TC_SR_LDRBS
+  #define TC_IMR_CPAS TC_SR_CPAS
+  #define TC_IMR_CPCS TC_SR_CPCS
+  #define TC_IMR_LDRAS TC_SR_LDRAS
+  #define TC_IMR_LDRBS TC_SR_LDRBS
+
+  // PIO configuration
+  typedef enum _EPioType
+  {
+    PIO_NOT_A_PIN,
+    PIO_PERIPH_A,
+    PIO_PERIPH_B,
+    PIO_PERIPH_C,
+    PIO_PERIPH_D,
+    PIO_INPUT,
+    PIO_OUTPUT_0,
+    PIO_OUTPUT_1
+  } EPioType;
+
+  #define PIO_DEFAULT (0x0u<<0)
+  #define PIO_PULLUP (0x1u<<0)
+
+  typedef enum _ETCChannel
+  {
+    NOT_ON_TIMER=-1,
+    TC0_CHA0=0, TC0_CHB0, TC0_CHA1, TC0_CHB1, TC0_CHA2, TC0_CHB2,
+    TC1_CHA3, TC1_CHB3, TC1_CHA4, TC1_CHB4, TC1_CHA5, TC1_CHB5,
+    TC2_CHA6, TC2_CHB6, TC2_CHA7, TC2_CHB7, TC2_CHA8, TC2_CHB8
+  } ETCChannel;
+
+  namespace soft_uart
+  {
+
+    namespace host
+    {
+
+      // NOTE: simulation time is kept in fractions of the nominal TC 
+      // tick (VARIANT_MCK/2), so each TC channel may have its own 
+      // clock period
+      typedef uint64_t sim_time;
+
+      static constexpr uint32_t SIM_TIME_BITS=20;
+      static constexpr sim_time SIM_TICK=(sim_time(1)<<SIM_TIME_BITS);
+      static constexpr sim_time NEVER=~sim_time(0);
+
+      static constexpr uint32_t TC_CHANNELS=9;
+      static constexpr uint32_t PIO_CONTROLLERS=4;
+
+      // register accesses are forwarded to the peripheral models
+      template<typename MODEL,uint32_t REGISTER>
+      class register_proxy
+      {
+        public:
+
+          explicit register_proxy(MODEL* the_model): _model_(the_model) {}
+
+          register_proxy(const register_proxy&) = delete;
+          register_proxy& operator=(const register_proxy&) = delete;
+
+          operator uint32_t() const { return _model_->read(REGISTER); }
+
+          register_proxy& operator=(uint32_t value) 
+          { _model_->write(REGISTER,value); return *this; }
+
+        private:
+
+          MODEL* _model_;
+      };
+
+      enum tc_registers: uint32_t
+      {
+        TC_CCR_REG, TC_CMR_REG, TC_CV_REG, TC_RA_REG, TC_RB_REG, 
+        TC_RC_REG, TC_SR_REG, TC_IER_REG, TC_IDR_REG, TC_IMR_REG
+      };
+
+      class tc_channel_model
+      {
+        public:
+
+          void reset(uint32_t the_id);
+
+          uint32_t read(uint32_t reg);
+          void write(uint32_t reg,uint32_t value);
+
+          // time of the next compare, or NEVER
+          sim_time get_next_event();
+
+          // counts the ticks up to now, firing the compare on the last 
+          void run_until(sim_time now);
+
+          // edge on TIOA (in capture mode)
+          void tioa_edge(uint32_t level);
+
+          bool is_irq_asserted() { return (_sr_ & _imr_); }
+
+          void set_clock_period(sim_time period) { _tick_period_=period; }
+
+          uint32_t get_id() { return _id_; }
+
+        private:
+
+          bool is_waveform() { return (_cmr_ & TC_CMR_WAVE); }
+
+          bool is_reset_on_rc() 
+          { 
+            return (
+              (_cmr_ & TC_CMR_WAVSEL_Msk)==
+                ((is_waveform())? TC_CMR_WAVSEL_UP_RC: TC_CMR_CPCTRG)
+            ); 
+          }
+
+          void set_tioa(uint32_t action);
+          void drive_tioa();
+
+          uint32_t _id_;
+          uint32_t _cmr_;
+          uint32_t _cv_;
+          uint32_t _ra_;
+          uint32_t _rb_;
+          uint32_t _rc_;
+          uint32_t _sr_;
+          uint32_t _imr_;
+          uint32_t _tioa_;
+          bool _clock_enabled_;
+          bool _rb_next_;
+
+          // NOTE: the counter matched RC (reset on RC compare), so it 
+          // goes to 0 on the next tick, even if RC is changed meanwhile
+          bool _rc_reset_;
+
+          // the counter holds _cv_ since tick _cv_time_
+          sim_time _cv_time_;
+          sim_time _tick_period_;
+      };
+
+      enum pio_registers: uint32_t
+      {
+        PIO_PER_REG, PIO_PDR_REG, PIO_PSR_REG, PIO_OER_REG, PIO_ODR_REG, 
+        PIO_OSR_REG, PIO_IER_REG, PIO_IDR_REG, PIO_IMR_REG, PIO_ISR_REG, 
+        PIO_SODR_REG, PIO_CODR_REG, PIO_ODSR_REG, PIO_PDSR_REG, 
+        PIO_OWER_REG, PIO_OWDR_REG, PIO_OWSR_REG
+      };
+
+      class pio_model
+      {
+        public:
+
+          void reset(uint32_t the_id);
+
+          uint32_t read(uint32_t reg);
+          void write(uint32_t reg,uint32_t value);
+
+          void configure(EPioType type,uint32_t mask);
+
+          // lines driven from outside the micro-controller
+          void drive(uint32_t mask,uint32_t levels);
+          void release(uint32_t mask);
+
+          // lines driven by a peripheral (TIOA in waveform mode)
+          void peripheral_drive(uint32_t mask,bool driving,uint32_t levels);
+
+          uint32_t get_levels() { return _pdsr_; }
+
+          bool is_irq_asserted() { return (_isr_ & _imr_); }
+
+          uint32_t get_id() { return _id_; }
+
+        private:
+
+          void update();
+
+          uint32_t _id_;
+          uint32_t _psr_; // 1: the PIO controls the line
+          uint32_t _osr_;
+          uint32_t _odsr_;
+          uint32_t _owsr_;
+          uint32_t _imr_;
+          uint32_t _isr_;
+          uint32_t _pdsr_;
+          uint32_t _external_driven_;
+          uint32_t _external_levels_;
+          uint32_t _peripheral_driven_;
+          uint32_t _peripheral_levels_;
+      };
+
+      // simulation control
+      void reset();
+
+      sim_time get_time();
+      void run_until(sim_time the_time);
+      void run_for(uint32_t ticks);
+
+      // NOTE: the busy waits of the library let the simulation go up 
+      // to the next event
+      void busy_wait();
+
+      // pins as seen from outside the micro-controller
+      uint32_t get_pin_level(uint32_t pin);
+      void drive_pin(uint32_t pin,uint32_t level);
+      void release_pin(uint32_t pin);
+
+      typedef void (*pin_callback)(uint32_t pin,uint32_t level);
+      void on_pin_change(uint32_t pin,pin_callback callback);
+
+      // NOTE: each TC channel can have its own clock deviation from 
+      // the nominal VARIANT_MCK/2 in parts per million
+      void set_tc_clock_ppm(uint32_t channel,int32_t ppm);
+
+      // NOTE: a wire drives to_pin with the level of from_pin latency 
+      // later, every pin is the source of one wire at most
+      void connect_pins(uint32_t from_pin,uint32_t to_pin,sim_time latency=0);
+      void disconnect_pin(uint32_t from_pin);
+
+      // NOTE: events scheduled for the same time are run in the order 
+      // they were scheduled
+      typedef void (*event_callback)(uint32_t arg_0,uint32_t arg_1);
+      void schedule_event(
+        sim_time the_time,
+        event_callback callback,
+        uint32_t arg_0,
+        uint32_t arg_1
+      );
+
+      // NOTE: time from an interrupt request up to the entry to its 
+      // handler, uniformly distributed between min_latency and 
+      // max_latency (by default, there is no latency at all)
+      void set_interrupt_latency(sim_time min_latency,sim_time max_latency);
+
+      // NOTE: runs the pending interrupts (if not masked)
+      void dispatch_interrupts();
+
+      // NOTE: cycle source for profiling the interrupt handlers, as 
+      // they take no simulated time it counts nanoseconds of the host
+      // monotonic clock
+      struct cycle_source
+      {
+        static void enable() {}
+        static uint32_t get_cycles();
+      };
+
+    } // namespace host
+
+  } // namespace soft_uart
+
+  struct TcChannel
+  {
+    TcChannel();
+
+    soft_uart::host::tc_channel_model model;
+
+    soft_uart::host::register_proxy<
+      soft_uart::host::tc_channel_model,soft_uart::host::TC_CCR_REG
+    > TC_CCR;
+    soft_uart::host::register_proxy<
+      soft_uart::host::tc_channel_model,soft_uart::host::TC_CMR_REG
+    > TC_CMR;
+    soft_uart::host::register_proxy<
+      soft_uart::host::tc_channel_model,soft_uart::host::TC_CV_REG
+    > TC_CV;
+    soft_uart::host::register_proxy<
+      soft_uart::host::tc_channel_model,soft_uart::host::TC_RA_REG
+    > TC_RA;
+    soft_uart::host::register_proxy<
+      soft_uart::host::tc_channel_model,soft_uart::host::TC_RB_REG
+    > TC_RB;
+    soft_uart::host::register_proxy<
+      soft_uart::host::tc_channel_model,soft_uart::host::TC_RC_REG
+    > TC_RC;
+    soft_uart::host::register_proxy<
+      soft_uart::host::tc_channel_model,soft_uart::host::TC_SR_REG
+    > TC_SR;
+    soft_uart::host::register_proxy<
+      soft_uart::host::tc_channel_model,soft_uart::host::TC_IER_REG
+    > TC_IER;
+    soft_uart::host::register_proxy<
+      soft_uart::host::tc_channel_model,soft_uart::host::TC_IDR_REG
+    > TC_IDR;
+    soft_uart::host::register_proxy<
+      soft_uart::host::tc_channel_model,soft_uart::host::TC_IMR_REG
+    > TC_IMR;
+  };
+
+  struct Tc { TcChannel TC_CHANNEL[3]; };
+
+  extern Tc* TC0;
+  extern Tc* TC1;
+  extern Tc* TC2;
+
+  #define SOFT_UART_HOST_PIO_REGISTER(name) \
+    soft_uart::host::register_proxy< \
+      soft_uart::host::pio_model,soft_uart::host::name##_REG \
+    > name;
+
+  struct Pio
+  {
+    Pio();
+
+    soft_uart::host::pio_model model;
+
+    SOFT_UART_HOST_PIO_REGISTER(PIO_PER)
+    SOFT_UART_HOST_PIO_REGISTER(PIO_PDR)
+    SOFT_UART_HOST_PIO_REGISTER(PIO_PSR)
+    SOFT_UART_HOST_PIO_REGISTER(PIO_OER)
+    SOFT_UART_HOST_PIO_REGISTER(PIO_ODR)
+    SOFT_UART_HOST_PIO_REGISTER(PIO_OSR)
+    SOFT_UART_HOST_PIO_REGISTER(PIO_IER)
+    SOFT_UART_HOST_PIO_REGISTER(PIO_IDR)
+    SOFT_UART_HOST_PIO_REGISTER(PIO_IMR)
+    SOFT_UART_HOST_PIO_REGISTER(PIO_ISR)
+    SOFT_UART_HOST_PIO_REGISTER(PIO_SODR)
+    SOFT_UART_HOST_PIO_REGISTER(PIO_CODR)
+    SOFT_UART_HOST_PIO_REGISTER(PIO_ODSR)
+    SOFT_UART_HOST_PIO_REGISTER(PIO_PDSR)
+    SOFT_UART_HOST_PIO_REGISTER(PIO_OWER)
+    SOFT_UART_HOST_PIO_REGISTER(PIO_OWDR)
+    SOFT_UART_HOST_PIO_REGISTER(PIO_OWSR)
+  };
+
+  #undef SOFT_UART_HOST_PIO_REGISTER
+
+  extern Pio* PIOA;
+  extern Pio* PIOB;
+  extern Pio* PIOC;
+  extern Pio* PIOD;
+
+  struct PinDescription
+  {
+    Pio* pPort;
+    uint32_t ulPin;
+    uint32_t ulPeripheralId;
+    EPioType ulPinType;
+    uint32_t ulPinConfiguration;
+    uint32_t ulPinAttribute;
+    ETCChannel ulTCChannel;
+  };
+
+  extern const PinDescription g_APinDescription[];
+
+  // libsam
+  uint32_t PIO_Configure(
+    Pio* pio,
+    const EPioType type,
+    const uint32_t mask,
+    const uint32_t attribute
+  );
+
+  inline void PIO_Set(Pio* pio,const uint32_t mask) { pio->PIO_SODR=mask; }
+  inline void PIO_Clear(Pio* pio,const uint32_t mask) { pio->PIO_CODR=mask; }
+
+  inline uint32_t PIO_Get(Pio* pio,const EPioType type,const uint32_t mask)
+  {
+    uint32_t levels=
+      (type==PIO_OUTPUT_0 || type==PIO_OUTPUT_1)? 
+        pio->PIO_ODSR: pio->PIO_PDSR;
+    return ((levels & mask)? 1: 0);
+  }
+
+  inline void TC_Configure(Tc* tc,uint32_t channel,uint32_t mode)
+  {
+    tc->TC_CHANNEL[channel].TC_CCR=TC_CCR_CLKDIS;
+    tc->TC_CHANNEL[channel].TC_IDR=0xFFFFFFFF;
+    (void)static_cast<uint32_t>(tc->TC_CHANNEL[channel].TC_SR);
+    tc->TC_CHANNEL[channel].TC_CMR=mode;
+  }
+
+  inline void TC_Start(Tc* tc,uint32_t channel)
+  { tc->TC_CHANNEL[channel].TC_CCR=TC_CCR_CLKEN|TC_CCR_SWTRG; }
+
+  inline void TC_Stop(Tc* tc,uint32_t channel)
+  { tc->TC_CHANNEL[channel].TC_CCR=TC_CCR_CLKDIS; }
+
+  inline void TC_SetRA(Tc* tc,uint32_t channel,uint32_t value)
+  { tc->TC_CHANNEL[channel].TC_RA=value; }
+
+  inline void TC_SetRB(Tc* tc,uint32_t channel,uint32_t value)
+  { tc->TC_CHANNEL[channel].TC_RB=value; }
+
+  inline void TC_SetRC(Tc* tc,uint32_t channel,uint32_t value)
+  { tc->TC_CHANNEL[channel].TC_RC=value; }
+
+  inline uint32_t TC_GetStatus(Tc* tc,uint32_t channel)
+  { return tc->TC_CHANNEL[channel].TC_SR; }
+
+  inline void pmc_set_writeprotect(uint32_t) {}
+  inline uint32_t pmc_enable_periph_clk(uint32_t) { return 0; }
+  inline uint32_t pmc_disable_periph_clk(uint32_t) { return 0; }
+
+  // Arduino core
+  void pinMode(uint32_t pin,uint32_t mode);
+  void digitalWrite(uint32_t pin,uint32_t level);
+  int digitalRead(uint32_t pin);
+
+  void attachInterrupt(uint32_t pin,void (*callback)(void),uint32_t mode);
+  void detachInterrupt(uint32_t pin);
+
+  uint32_t millis();
+  uint32_t micros();
+  void delay(uint32_t ms);
+  void delayMicroseconds(uint32_t us);
+
+  class Print
+  {
+    public:
+
+      virtual ~Print() {}
+
+      virtual size_t write(uint8_t data) = 0;
+
+      virtual size_t write(const uint8_t* buffer,size_t size)
+      {
+        size_t n=0;
+        while(size-- && write(*buffer++)) n++;
+        return n;
+      }
+
+      size_t write(const char* str)
+      { 
+        size_t n=0;
+        while(*str && write(static_cast<uint8_t>(*str++))) n++;
+        return n;
+      }
+  };
+
+  class Stream: public Print
+  {
+    public:
+
+      virtual int available() = 0;
+      virtual int read() = 0;
+      virtual int peek() = 0;
+      virtual void flush() = 0;
+  };
+
+  class HardwareSerial: public Stream
+  {
+    public:
+
+      virtual void begin(unsigned long) = 0;
+      virtual void end() = 0;
+      virtual operator bool() = 0;
+  };
+
+  // NOTE: the interrupt handlers are defined by the declaration macros
+  extern "C"
+  {
+    void TC0_Handler(void);
+    void TC1_Handler(void);
+    void TC2_Handler(void);
+    void TC3_Handler(void);
+    void TC4_Handler(void);
+    void TC5_Handler(void);
+    void TC6_Handler(void);
+    void TC7_Handler(void);
+    void TC8_Handler(void);
+  }
+
+#endif // HOST_PORT_H
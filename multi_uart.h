@@ -0,0 +1,989 @@
+/**
+ ** soft_uart library
+ ** Copyright (C) 2015-2020
+ **
+ **   Antonio C. Domínguez Brito <antonio.dominguez@ulpgc.es>
+ **     División de Robótica y Oceanografía Computacional <www.roc.siani.es>
+ **     and Departamento de Informática y Sistemas <www.dis.ulpgc.es>
+ **     Universidad de Las Palmas de Gran  Canaria (ULPGC) <www.ulpgc.es>
+ **
+ ** This file is part of the soft_uart library.
+ ** The soft_uart library is free software: you can redistribute it and/or modify
+ ** it under  the  terms of  the GNU  General  Public  License  as  published  by
+ ** the  Free Software Foundation, either  version  3  of  the  License,  or  any
+ ** later version.
+ **
+ ** The  soft_uart library is distributed in the hope that  it  will  be  useful,
+ ** but   WITHOUT   ANY WARRANTY;   without   even   the  implied   warranty   of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR  PURPOSE.  See  the  GNU  General
+ ** Public License for more details.
+ **
+ ** You should have received a copy  (COPYING file) of  the  GNU  General  Public
+ ** License along with the soft_uart library.
+ ** If not, see: <http://www.gnu.org/licenses/>.
+ **/
+/*
+ * File: multi_uart.h
+ * Description: Software UART engines serving several ports, all of them on
+ * the same PIO controller and with the same serial  protocol,  with  just
+ * one timer/counter channel of the Arduino Due's Atmel ATSAM3X8E.
+ * Date: October 17th, 2026
+ * Author: Antonio C. Dominguez-Brito <antonio.dominguez@ulpgc.es>
+ * ROC-SIANI - Universidad de Las Palmas de Gran Canaria - Spain
+ */
+
+#ifndef MULTI_UART_H
+  #define MULTI_UART_H
+
+  #include "soft_uart.h"
+
+  #ifndef CHIBIOS_PORT
+
+    #define multi_uart_rx_declaration(id,name,rx_length,...) \
+    void TC##id##_Handler(void) \
+    { \
+      uint32_t status=TC_GetStatus( \
+        soft_uart::arduino_due::tc_timer_table[ \
+          static_cast<uint32_t>( \
+            soft_uart::arduino_due::timer_ids::TIMER_TC##id \
+          ) \
+        ].tc_p, \
+        soft_uart::arduino_due::tc_timer_table[ \
+          static_cast<uint32_t>( \
+            soft_uart::arduino_due::timer_ids::TIMER_TC##id \
+          ) \
+        ].channel \
+      ); \
+      \
+      soft_uart::arduino_due::multi_uart_rx< \
+        soft_uart::arduino_due::timer_ids::TIMER_TC##id, \
+        rx_length, \
+        __VA_ARGS__ \
+      >::tc_interrupt(status); \
+    } \
+    \
+    typedef soft_uart::arduino_due::multi_uart_rx< \
+      soft_uart::arduino_due::timer_ids::TIMER_TC##id, \
+      rx_length, \
+      __VA_ARGS__ \
+    > name##_t; \
+    \
+    name##_t name;
+
+    #define multi_uart_tx_declaration(id,name,tx_length,...) \
+    void TC##id##_Handler(void) \
+    { \
+      uint32_t status=TC_GetStatus( \
+        soft_uart::arduino_due::tc_timer_table[ \
+          static_cast<uint32_t>( \
+            soft_uart::arduino_due::timer_ids::TIMER_TC##id \
+          ) \
+        ].tc_p, \
+        soft_uart::arduino_due::tc_timer_table[ \
+          static_cast<uint32_t>( \
+            soft_uart::arduino_due::timer_ids::TIMER_TC##id \
+          ) \
+        ].channel \
+      ); \
+      \
+      soft_uart::arduino_due::multi_uart_tx< \
+        soft_uart::arduino_due::timer_ids::TIMER_TC##id, \
+        tx_length, \
+        __VA_ARGS__ \
+      >::tc_interrupt(status); \
+    } \
+    \
+    typedef soft_uart::arduino_due::multi_uart_tx< \
+      soft_uart::arduino_due::timer_ids::TIMER_TC##id, \
+      tx_length, \
+      __VA_ARGS__ \
+    > name##_t; \
+    \
+    name##_t name;
+
+    namespace soft_uart
+    {
+
+      namespace arduino_due
+      {
+
+        // NOTE: multi_uart_rx receives on all the RX_PINS with just one
+        // TC channel, all the pins must belong to the same PIO
+        // controller, since it is sampled reading its PIO_PDSR once
+        // per timer tick (four ticks per bit), and all the ports are
+        // decoded at once, using one bit per port (the bit of its pin
+        // in the PIO controller) in each 32 bit word of its state
+        template<
+          timer_ids TIMER,
+          size_t RX_BUFFER_LENGTH,
+          uint32_t... RX_PINS
+        > class multi_uart_rx
+        {
+          static_assert(TIMER<timer_ids::TIMER_IDS,"[ERROR] Bad TC id provided to instantiate template multi_uart_rx");
+          static_assert(sizeof...(RX_PINS)>0,"[ERROR] No RX pins provided to instantiate template multi_uart_rx");
+          static_assert(sizeof...(RX_PINS)<=32,"[ERROR] Too many RX pins provided to instantiate template multi_uart_rx");
+
+          public:
+
+            static constexpr uint32_t PORTS=sizeof...(RX_PINS);
+
+            multi_uart_rx() { _configured_=false; }
+
+            ~multi_uart_rx() { end(); }
+
+            multi_uart_rx(const multi_uart_rx&) = delete;
+            multi_uart_rx(multi_uart_rx&&) = delete;
+            multi_uart_rx& operator=(const multi_uart_rx&) = delete;
+            multi_uart_rx& operator=(multi_uart_rx&&) = delete;
+
+            return_codes config(
+              uint32_t bit_rate = bit_rates::DEFAULT_BIT_RATE,
+              data_bit_codes the_data_bits = data_bit_codes::EIGHT_BITS,
+              parity_codes the_parity = parity_codes::EVEN_PARITY,
+              stop_bit_codes the_stop_bits = stop_bit_codes::ONE_STOP_BIT
+            )
+            {
+              end();
+
+              return_codes ret_code=
+                _ctx_.config(
+                  bit_rate,
+                  the_data_bits,
+                  the_parity,
+                  the_stop_bits
+                );
+
+              _configured_=(ret_code==return_codes::EVERYTHING_OK);
+              return ret_code;
+            }
+
+            void end()
+            {
+              if(_configured_) _ctx_.end();
+              _configured_=false;
+            }
+
+            static void tc_interrupt(uint32_t the_status)
+            { _ctx_.tc_interrupt(the_status); }
+
+            timer_ids get_timer() { return TIMER; }
+
+            uint32_t get_ports() { return PORTS; }
+
+            size_t get_rx_buffer_length() { return RX_BUFFER_LENGTH; }
+
+            uint32_t get_bit_rate() { return _ctx_.bit_rate; }
+            double get_bit_time() 
+            { return double(1)/double(_ctx_.bit_rate); }
+            double get_frame_time() 
+            { 
+              return 
+                double(_ctx_.format.tx_frame_bits)/double(_ctx_.bit_rate); 
+            }
+
+            int available(uint32_t port)
+            { return (port<PORTS)? _ctx_.available(port): 0; }
+
+            // NOTE: the status returned is the same than the one
+            // returned by uart::get_rx_data(), with DATA_LOST on the 
+            // first frame read after frames were lost on the port
+            uint32_t get_rx_data(uint32_t port,uint32_t& data)
+            {
+              return (
+                (_configured_ && (port<PORTS))?
+                  _ctx_.get_rx_data(port,data):
+                  static_cast<uint32_t>(
+                    rx_data_status_codes::NO_DATA_AVAILABLE
+                  )
+              );
+            }
+
+            static bool data_available(uint32_t status)
+            {
+              return (
+                status&(
+                  rx_data_status_codes::DATA_AVAILABLE|
+                  rx_data_status_codes::DATA_LOST
+                )
+              );
+            }
+
+            static bool data_lost(uint32_t status)
+            { return (status&rx_data_status_codes::DATA_LOST); }
+
+            static bool bad_status(uint32_t status)
+            {
+              return (
+                status&(
+                  rx_data_status_codes::BAD_START_BIT|
+                  rx_data_status_codes::BAD_PARITY|
+                  rx_data_status_codes::BAD_STOP_BIT
+                )
+              );
+            }
+
+            static bool bad_start_bit(uint32_t status)
+            { return (status&rx_data_status_codes::BAD_START_BIT); }
+
+            static bool bad_parity(uint32_t status)
+            { return (status&rx_data_status_codes::BAD_PARITY); }
+
+            static bool bad_stop_bit(uint32_t status)
+            { return (status&rx_data_status_codes::BAD_STOP_BIT); }
+
+            void flush_rx(uint32_t port)
+            { if(port<PORTS) _ctx_.flush_rx(port); }
+
+            // NOTE: a copy taken with interrupts disabled
+            link_statistics get_link_statistics(uint32_t port)
+            { 
+              interrupt_guard guard; 
+              return (port<PORTS)? _ctx_.statistics[port]: link_statistics(); 
+            }
+
+            void reset_link_statistics(uint32_t port)
+            { 
+              interrupt_guard guard; 
+              if(port<PORTS) _ctx_.statistics[port].reset(); 
+            }
+
+          private:
+
+            // NOTE: start bit, 9 data bits, parity and one stop bit
+            static constexpr uint32_t MAX_RX_FRAME_BITS=12;
+
+            struct _uart_ctx_
+            {
+
+              return_codes config(
+                uint32_t the_bit_rate,
+                data_bit_codes the_data_bits,
+                parity_codes the_parity,
+                stop_bit_codes the_stop_bits
+              );
+
+              void end()
+              {
+                NVIC_DisableIRQ(timer_p->irq);
+                TC_Stop(timer_p->tc_p,timer_p->channel);
+                pmc_disable_periph_clk(uint32_t(timer_p->irq));
+              }
+
+              void tc_interrupt(uint32_t the_status);
+
+              uint32_t get_rx_data(uint32_t port,uint32_t& data);
+
+              int available(uint32_t port)
+              { return rx_buffers[port].items(); }
+
+              void flush_rx(uint32_t port) { rx_buffers[port].reset(); }
+
+              void update_rx_data_buffer(uint32_t lane);
+
+              tc_timer_data* timer_p;
+              Pio* rx_pio_p;
+              uint32_t rx_mask;
+              uint32_t port_lanes[PORTS];
+              uint8_t lane_ports[32];
+
+              uint32_t bit_ticks;
+              uint32_t bit_1st_quarter;
+
+              // NOTE: the quarters of bit alternate between the floor 
+              // and the ceil of a quarter, keeping on the bit time
+              uint32_t fixed_bit_ticks;
+              uint32_t quarter_fraction;
+              uint32_t quarter_ticks;
+
+              // serial protocol (the same for all the ports)
+              uint32_t bit_rate;
+              runtime_frame_format format;
+
+              // NOTE: the frames are validated and counted on the
+              // statistics of their port as they are received
+              link_statistics statistics[PORTS];
+
+              // rx data
+              circular_spsc_fifo<frame_t,RX_BUFFER_LENGTH> rx_buffers[PORTS];
+
+              // NOTE: one bit per lane, set when a frame overwrote the 
+              // oldest one of its port, until the next frame is read
+              volatile uint32_t rx_overruns;
+
+              // NOTE: one bit per lane (PIO pin) in all these words,
+              // rx_planes[bit] holds the bit-th oldest bit sampled of
+              // each lane, so a frame is complete when its start bit
+              // (a zero) reaches rx_planes[0], since the planes of a
+              // lane are set to ones when its start bit is detected
+              volatile uint32_t rx_receiving;
+              volatile uint32_t rx_first_sample;
+              volatile uint32_t rx_phase_masks[4];
+              volatile uint32_t rx_planes[MAX_RX_FRAME_BITS];
+              volatile uint32_t rx_last_pdsr;
+              volatile uint32_t rx_tick;
+            };
+
+            static _uart_ctx_ _ctx_;
+
+            bool _configured_;
+        };
+
+        template<
+          timer_ids TIMER,
+          size_t RX_BUFFER_LENGTH,
+          uint32_t... RX_PINS
+        > typename multi_uart_rx<
+          TIMER,
+          RX_BUFFER_LENGTH,
+          RX_PINS...
+        >::_uart_ctx_
+          multi_uart_rx<TIMER,RX_BUFFER_LENGTH,RX_PINS...>::_ctx_;
+
+        template<
+          timer_ids TIMER,
+          size_t RX_BUFFER_LENGTH,
+          uint32_t... RX_PINS
+        > return_codes multi_uart_rx<
+          TIMER,
+          RX_BUFFER_LENGTH,
+          RX_PINS...
+        >::_uart_ctx_::config(
+          uint32_t the_bit_rate,
+          data_bit_codes the_data_bits,
+          parity_codes the_parity,
+          stop_bit_codes the_stop_bits
+        )
+        {
+          if(
+            (the_bit_rate<bit_rates::MIN_BIT_RATE) ||
+            (the_bit_rate>bit_rates::MAX_BIT_RATE)
+          ) return return_codes::BAD_BIT_RATE_ERROR;
+
+          const uint32_t rx_pins[PORTS]={RX_PINS...};
+
+          // all pins on the same PIO controller, and no pin twice
+          if(rx_pins[0]>=NUM_DIGITAL_PINS) return return_codes::BAD_RX_PIN;
+          rx_pio_p=g_APinDescription[rx_pins[0]].pPort;
+          rx_mask=0;
+          for(uint32_t port=0; port<PORTS; port++)
+          {
+            if(
+              (rx_pins[port]>=NUM_DIGITAL_PINS) ||
+              (g_APinDescription[rx_pins[port]].pPort!=rx_pio_p) ||
+              (rx_mask & g_APinDescription[rx_pins[port]].ulPin)
+            ) return return_codes::BAD_RX_PIN;
+
+            rx_mask|=g_APinDescription[rx_pins[port]].ulPin;
+            port_lanes[port]=
+              __builtin_ctz(g_APinDescription[rx_pins[port]].ulPin);
+            lane_ports[port_lanes[port]]=static_cast<uint8_t>(port);
+          }
+
+          timer_p=&(tc_timer_table[static_cast<uint32_t>(TIMER)]);
+          bit_rate=the_bit_rate;
+
+          // NOTE: we will be using the fastest clock for TC ticks
+          // just using a prescaler of 2
+          fixed_bit_ticks=get_fixed_bit_ticks((VARIANT_MCK)>>1,bit_rate);
+
+          bit_ticks=get_half_bit_ticks(fixed_bit_ticks,2);
+          bit_1st_quarter=(fixed_bit_ticks+(1<<(TICK_FRACTION_BITS+1)))>>
+            (TICK_FRACTION_BITS+2);
+          quarter_fraction=(1<<(TICK_FRACTION_BITS+1));
+          quarter_ticks=
+            advance_quarter_ticks(fixed_bit_ticks,quarter_fraction);
+
+          format.set(the_data_bits,the_parity,the_stop_bits);
+
+          for(uint32_t port=0; port<PORTS; port++) 
+          { rx_buffers[port].reset(); statistics[port].reset(); }
+          rx_overruns=0;
+
+          rx_receiving=rx_first_sample=0;
+          for(uint32_t phase=0; phase<4; phase++) rx_phase_masks[phase]=0;
+          rx_last_pdsr=0xFFFFFFFF; rx_tick=0;
+
+          for(uint32_t port=0; port<PORTS; port++)
+            pinMode(rx_pins[port],INPUT_PULLUP);
+
+          // PMC settings
+          pmc_set_writeprotect(0);
+          pmc_enable_periph_clk(uint32_t(timer_p->irq));
+
+          // timing setings
+          TC_Configure(
+            timer_p->tc_p,
+            timer_p->channel,
+            TC_CMR_TCCLKS_TIMER_CLOCK1 |
+            TC_CMR_WAVE |
+            TC_CMR_WAVSEL_UP_RC
+          );
+          TC_SetRC(timer_p->tc_p,timer_p->channel,quarter_ticks-1);
+          timer_p->tc_p->TC_CHANNEL[timer_p->channel].TC_IER=TC_IER_CPCS;
+
+          // NOTE: the timer runs all the time, since any port may
+          // start receiving a frame at any tick
+          NVIC_SetPriority(timer_p->irq,0);
+          NVIC_ClearPendingIRQ(timer_p->irq);
+          NVIC_EnableIRQ(timer_p->irq);
+          TC_Start(timer_p->tc_p,timer_p->channel);
+
+          return return_codes::EVERYTHING_OK;
+        }
+
+        template<
+          timer_ids TIMER,
+          size_t RX_BUFFER_LENGTH,
+          uint32_t... RX_PINS
+        > void multi_uart_rx<
+          TIMER,
+          RX_BUFFER_LENGTH,
+          RX_PINS...
+        >::_uart_ctx_::tc_interrupt(
+          uint32_t the_status
+        )
+        {
+          if(!(the_status & TC_SR_CPCS)) return;
+
+          register uint32_t pdsr=rx_pio_p->PIO_PDSR;
+
+          // the period of the quarter just begun
+          register uint32_t ticks=
+            advance_quarter_ticks(fixed_bit_ticks,quarter_fraction);
+          if(ticks!=quarter_ticks)
+          { quarter_ticks=ticks; timer_p->set_rc_period(ticks); }
+
+          register uint32_t tick=rx_tick=(rx_tick+1)&0x3;
+          register uint32_t receiving=rx_receiving;
+
+          register uint32_t rx_frame_bits=format.rx_frame_bits;
+
+          // lanes sampling the middle of a bit on this tick
+          register uint32_t sampled=receiving & rx_phase_masks[tick];
+          if(sampled)
+          {
+            // NOTE: a start bit that is not low at its middle is
+            // taken as a glitch, and the lane goes back to listen
+            register uint32_t glitches=sampled & rx_first_sample & pdsr;
+            rx_first_sample=rx_first_sample & ~sampled;
+            sampled=sampled & ~glitches;
+
+            for(uint32_t bit=0; bit+1<rx_frame_bits; bit++)
+              rx_planes[bit]=
+                (rx_planes[bit] & ~sampled) | (rx_planes[bit+1] & sampled);
+            rx_planes[rx_frame_bits-1]=
+              (rx_planes[rx_frame_bits-1] & ~sampled) | (pdsr & sampled);
+
+            register uint32_t done=sampled & ~rx_planes[0];
+            receiving=receiving & ~(done|glitches);
+            rx_phase_masks[tick]=rx_phase_masks[tick] & ~(done|glitches);
+
+            while(done)
+            {
+              update_rx_data_buffer(__builtin_ctz(done));
+              done=done & (done-1);
+            }
+          }
+
+          // start bits (falling edges on listening lanes)
+          register uint32_t starts=rx_mask & ~receiving & rx_last_pdsr & ~pdsr;
+          if(starts)
+          {
+            // NOTE: the edge happened during the last quarter of bit,
+            // so the middle of the start bit is two ticks later
+            receiving=receiving | starts;
+            rx_first_sample=rx_first_sample | starts;
+            rx_phase_masks[(tick+2)&0x3]=rx_phase_masks[(tick+2)&0x3] | starts;
+            for(uint32_t bit=0; bit<rx_frame_bits; bit++)
+              rx_planes[bit]=rx_planes[bit] | starts;
+          }
+
+          rx_receiving=receiving;
+          rx_last_pdsr=pdsr;
+        }
+
+        template<
+          timer_ids TIMER,
+          size_t RX_BUFFER_LENGTH,
+          uint32_t... RX_PINS
+        > void multi_uart_rx<
+          TIMER,
+          RX_BUFFER_LENGTH,
+          RX_PINS...
+        >::_uart_ctx_::update_rx_data_buffer(
+          uint32_t lane
+        )
+        {
+          register uint32_t rx_frame_bits=format.rx_frame_bits;
+          register uint32_t data=0;
+          for(uint32_t bit=0; bit<rx_frame_bits; bit++)
+            data|=((rx_planes[bit]>>lane)&1)<<bit;
+
+          if(format.stop_bits==stop_bit_codes::TWO_STOP_BITS)
+            data|=((data>>(rx_frame_bits-1))&1)<<rx_frame_bits;
+
+          register uint32_t port=lane_ports[lane];
+          register uint32_t status=store_rx_frame(
+            format,
+            rx_buffers[port],
+            statistics[port],
+            static_cast<frame_t>(data)
+          );
+
+          if(status&rx_data_status_codes::DATA_LOST) 
+            rx_overruns=rx_overruns | (1<<lane);
+        }
+
+        template<
+          timer_ids TIMER,
+          size_t RX_BUFFER_LENGTH,
+          uint32_t... RX_PINS
+        > uint32_t multi_uart_rx<
+          TIMER,
+          RX_BUFFER_LENGTH,
+          RX_PINS...
+        >::_uart_ctx_::get_rx_data(
+          uint32_t port,
+          uint32_t& data
+        )
+        {
+          frame_t data_received;
+
+          if(!rx_buffers[port].pop(data_received)) 
+            return rx_data_status_codes::NO_DATA_AVAILABLE;
+
+          // NOTE: the same validation as the uarts on the core
+          register uint32_t status=get_frame_status(format,data_received);
+
+          // NOTE: the overrun is reported (just once) on the first 
+          // frame read after it
+          register uint32_t lane_mask=(1<<port_lanes[port]);
+          if(rx_overruns & lane_mask)
+          {
+            { interrupt_guard guard; rx_overruns=rx_overruns & ~lane_mask; }
+
+            status=(status&(~rx_data_status_codes::DATA_AVAILABLE))|
+              rx_data_status_codes::DATA_LOST;
+          }
+
+          data=(data_received>>1)&format.data_mask;
+
+          return status;
+        }
+
+        // NOTE: multi_uart_tx transmits on all the TX_PINS with just one
+        // TC channel interrupting once per bit, all the pins must belong 
+        // to the same PIO controller, since all of them are updated at 
+        // once with just one write to its PIO_ODSR (only the TX pins are 
+        // enabled in PIO_OWSR)
+        template<
+          timer_ids TIMER,
+          size_t TX_BUFFER_LENGTH,
+          uint32_t... TX_PINS
+        > class multi_uart_tx
+        {
+          static_assert(TIMER<timer_ids::TIMER_IDS,"[ERROR] Bad TC id provided to instantiate template multi_uart_tx");
+          static_assert(sizeof...(TX_PINS)>0,"[ERROR] No TX pins provided to instantiate template multi_uart_tx");
+          static_assert(sizeof...(TX_PINS)<=32,"[ERROR] Too many TX pins provided to instantiate template multi_uart_tx");
+
+          public:
+
+            static constexpr uint32_t PORTS=sizeof...(TX_PINS);
+
+            multi_uart_tx() { _configured_=false; }
+
+            ~multi_uart_tx() { end(); }
+
+            multi_uart_tx(const multi_uart_tx&) = delete;
+            multi_uart_tx(multi_uart_tx&&) = delete;
+            multi_uart_tx& operator=(const multi_uart_tx&) = delete;
+            multi_uart_tx& operator=(multi_uart_tx&&) = delete;
+
+            return_codes config(
+              uint32_t bit_rate = bit_rates::DEFAULT_BIT_RATE,
+              data_bit_codes the_data_bits = data_bit_codes::EIGHT_BITS,
+              parity_codes the_parity = parity_codes::EVEN_PARITY,
+              stop_bit_codes the_stop_bits = stop_bit_codes::ONE_STOP_BIT
+            )
+            {
+              end();
+
+              return_codes ret_code=
+                _ctx_.config(
+                  bit_rate,
+                  the_data_bits,
+                  the_parity,
+                  the_stop_bits
+                );
+
+              _configured_=(ret_code==return_codes::EVERYTHING_OK);
+              return ret_code;
+            }
+
+            void end()
+            {
+              if(_configured_) _ctx_.end();
+              _configured_=false;
+            }
+
+            static void tc_interrupt(uint32_t the_status)
+            { _ctx_.tc_interrupt(the_status); }
+
+            timer_ids get_timer() { return TIMER; }
+
+            uint32_t get_ports() { return PORTS; }
+
+            size_t get_tx_buffer_length() { return TX_BUFFER_LENGTH; }
+
+            uint32_t get_bit_rate() { return _ctx_.bit_rate; }
+            double get_bit_time() 
+            { return double(1)/double(_ctx_.bit_rate); }
+            double get_frame_time() 
+            { 
+              return 
+                double(_ctx_.format.tx_frame_bits)/double(_ctx_.bit_rate); 
+            }
+
+            // is TX buffer full?
+            bool is_tx_full(uint32_t port)
+            { return (port<PORTS)? _ctx_.is_tx_full(port): false; }
+
+            int available_for_write(uint32_t port)
+            { return (port<PORTS)? _ctx_.available_for_write(port): 0; }
+
+            // NOTE: data is 5, 6, 7, 8 or 9 bits length
+            bool set_tx_data(uint32_t port,uint32_t data)
+            {
+              return (
+                (_configured_ && (port<PORTS))? 
+                  _ctx_.set_tx_data(port,data): false
+              );
+            }
+
+            // SENDING while any port is sending
+            tx_status_codes get_tx_status() { return _ctx_.tx_status; }
+
+            void flush() { _ctx_.flush(); }
+
+          private:
+
+            // NOTE: start bit, 9 data bits, parity and two stop bits
+            static constexpr uint32_t MAX_TX_FRAME_BITS=13;
+
+            struct _uart_ctx_
+            {
+
+              return_codes config(
+                uint32_t the_bit_rate,
+                data_bit_codes the_data_bits,
+                parity_codes the_parity,
+                stop_bit_codes the_stop_bits
+              );
+
+              void end()
+              {
+                flush();
+
+                NVIC_DisableIRQ(timer_p->irq);
+                TC_Stop(timer_p->tc_p,timer_p->channel);
+                pmc_disable_periph_clk(uint32_t(timer_p->irq));
+
+                tx_pio_p->PIO_OWDR=tx_mask;
+              }
+
+              void tc_interrupt(uint32_t the_status);
+
+              bool is_tx_full(uint32_t port)
+              {
+                interrupt_guard guard;
+                return tx_buffers[port].is_full();
+              }
+
+              int available_for_write(uint32_t port)
+              {
+                interrupt_guard guard;
+                return tx_buffers[port].available();
+              }
+
+              bool set_tx_data(uint32_t port,uint32_t data);
+
+              void flush()
+              {
+                // wait until sending everything
+                while(tx_status!=tx_status_codes::IDLE)
+                { busy_wait(); }
+              }
+
+              void update_tx_output();
+
+              tc_timer_data* timer_p;
+              Pio* tx_pio_p;
+              uint32_t tx_mask;
+              uint32_t port_lanes[PORTS];
+              uint8_t lane_ports[32];
+
+              uint32_t bit_ticks;
+
+              // NOTE: the bits alternate between the floor and the ceil 
+              // of a bit, keeping on the bit time
+              uint32_t fixed_bit_ticks;
+              uint32_t bit_fraction;
+              uint32_t bit_period;
+
+              // serial protocol (the same for all the ports)
+              uint32_t bit_rate;
+              runtime_frame_format format;
+
+              // tx data
+              fifo<frame_t,TX_BUFFER_LENGTH> tx_buffers[PORTS];
+
+              // NOTE: one bit per lane (PIO pin) in all these words, as
+              // all the lanes send one bit per tick, the bits of a frame
+              // are laid out in tx_slots from the slot of its start bit,
+              // and the frame ends when tx_slot gets back to that slot
+              // (where the lane is marked in tx_frame_ends)
+              volatile uint32_t tx_slots[MAX_TX_FRAME_BITS];
+              volatile uint32_t tx_frame_ends[MAX_TX_FRAME_BITS];
+              volatile uint32_t tx_slot;
+              volatile uint32_t tx_busy;
+              volatile uint32_t tx_pending;
+              volatile uint32_t tx_output;
+              volatile tx_status_codes tx_status;
+            };
+
+            static _uart_ctx_ _ctx_;
+
+            bool _configured_;
+        };
+
+        template<
+          timer_ids TIMER,
+          size_t TX_BUFFER_LENGTH,
+          uint32_t... TX_PINS
+        > typename multi_uart_tx<
+          TIMER,
+          TX_BUFFER_LENGTH,
+          TX_PINS...
+        >::_uart_ctx_
+          multi_uart_tx<TIMER,TX_BUFFER_LENGTH,TX_PINS...>::_ctx_;
+
+        template<
+          timer_ids TIMER,
+          size_t TX_BUFFER_LENGTH,
+          uint32_t... TX_PINS
+        > return_codes multi_uart_tx<
+          TIMER,
+          TX_BUFFER_LENGTH,
+          TX_PINS...
+        >::_uart_ctx_::config(
+          uint32_t the_bit_rate,
+          data_bit_codes the_data_bits,
+          parity_codes the_parity,
+          stop_bit_codes the_stop_bits
+        )
+        {
+          if(
+            (the_bit_rate<bit_rates::MIN_BIT_RATE) ||
+            (the_bit_rate>bit_rates::MAX_BIT_RATE)
+          ) return return_codes::BAD_BIT_RATE_ERROR;
+
+          const uint32_t tx_pins[PORTS]={TX_PINS...};
+
+          // all pins on the same PIO controller, and no pin twice
+          if(tx_pins[0]>=NUM_DIGITAL_PINS) return return_codes::BAD_TX_PIN;
+          tx_pio_p=g_APinDescription[tx_pins[0]].pPort;
+          tx_mask=0;
+          for(uint32_t port=0; port<PORTS; port++)
+          {
+            if(
+              (tx_pins[port]>=NUM_DIGITAL_PINS) ||
+              (g_APinDescription[tx_pins[port]].pPort!=tx_pio_p) ||
+              (tx_mask & g_APinDescription[tx_pins[port]].ulPin)
+            ) return return_codes::BAD_TX_PIN;
+
+            tx_mask|=g_APinDescription[tx_pins[port]].ulPin;
+            port_lanes[port]=
+              __builtin_ctz(g_APinDescription[tx_pins[port]].ulPin);
+            lane_ports[port_lanes[port]]=static_cast<uint8_t>(port);
+          }
+
+          timer_p=&(tc_timer_table[static_cast<uint32_t>(TIMER)]);
+          bit_rate=the_bit_rate;
+
+          // NOTE: we will be using the fastest clock for TC ticks
+          // just using a prescaler of 2
+          fixed_bit_ticks=get_fixed_bit_ticks((VARIANT_MCK)>>1,bit_rate);
+          bit_ticks=get_half_bit_ticks(fixed_bit_ticks,2);
+
+          format.set(the_data_bits,the_parity,the_stop_bits);
+
+          for(uint32_t port=0; port<PORTS; port++) tx_buffers[port].reset();
+
+          for(uint32_t slot=0; slot<MAX_TX_FRAME_BITS; slot++)
+          { tx_slots[slot]=0xFFFFFFFF; tx_frame_ends[slot]=0; }
+          tx_slot=tx_busy=tx_pending=0;
+          tx_output=0xFFFFFFFF;
+          tx_status=tx_status_codes::IDLE;
+
+          for(uint32_t port=0; port<PORTS; port++)
+          {
+            pinMode(tx_pins[port],OUTPUT);
+            digitalWrite(tx_pins[port],HIGH);
+          }
+
+          // NOTE: only the TX pins are affected by PIO_ODSR writes
+          tx_pio_p->PIO_OWER=tx_mask;
+
+          // PMC settings
+          pmc_set_writeprotect(0);
+          pmc_enable_periph_clk(uint32_t(timer_p->irq));
+
+          // timing setings
+          TC_Configure(
+            timer_p->tc_p,
+            timer_p->channel,
+            TC_CMR_TCCLKS_TIMER_CLOCK1 |
+            TC_CMR_WAVE |
+            TC_CMR_WAVSEL_UP_RC
+          );
+          TC_SetRC(timer_p->tc_p,timer_p->channel,bit_ticks-1);
+          timer_p->tc_p->TC_CHANNEL[timer_p->channel].TC_IER=TC_IER_CPCS;
+
+          NVIC_SetPriority(timer_p->irq,0);
+          NVIC_ClearPendingIRQ(timer_p->irq);
+          NVIC_EnableIRQ(timer_p->irq);
+
+          return return_codes::EVERYTHING_OK;
+        }
+
+        template<
+          timer_ids TIMER,
+          size_t TX_BUFFER_LENGTH,
+          uint32_t... TX_PINS
+        > void multi_uart_tx<
+          TIMER,
+          TX_BUFFER_LENGTH,
+          TX_PINS...
+        >::_uart_ctx_::update_tx_output()
+        {
+          register uint32_t slot=tx_slot;
+          register uint32_t tx_frame_bits=format.tx_frame_bits;
+
+          // lanes whose frame ended with the previous bit
+          register uint32_t busy=tx_busy & ~tx_frame_ends[slot];
+          tx_frame_ends[slot]=0;
+
+          // the next frame of each idle lane with data starts now
+          register uint32_t starting=tx_pending & ~busy;
+          while(starting)
+          {
+            register uint32_t lane=__builtin_ctz(starting);
+            register uint32_t lane_mask=(1<<lane);
+            starting=starting & (starting-1);
+
+            // NOTE: a lane is only pending with frames to send
+            frame_t data=0;
+            fifo<frame_t,TX_BUFFER_LENGTH>& tx_buffer=
+              tx_buffers[lane_ports[lane]];
+            tx_buffer.pop(data);
+            if(tx_buffer.is_empty()) tx_pending=tx_pending & ~lane_mask;
+
+            register uint32_t data_slot=slot;
+            for(uint32_t bit=0; bit<tx_frame_bits; bit++)
+            {
+              if(!((data>>bit) & 1))
+                tx_slots[data_slot]=tx_slots[data_slot] & ~lane_mask;
+              data_slot=(data_slot+1==tx_frame_bits)? 0: data_slot+1;
+            }
+
+            busy=busy | lane_mask;
+            tx_frame_ends[slot]=tx_frame_ends[slot] | lane_mask;
+          }
+
+          // NOTE: the slot is left idle (all ones) once it is taken
+          tx_output=tx_slots[slot]; tx_slots[slot]=0xFFFFFFFF;
+          tx_slot=(slot+1==tx_frame_bits)? 0: slot+1;
+          tx_busy=busy;
+        }
+
+        template<
+          timer_ids TIMER,
+          size_t TX_BUFFER_LENGTH,
+          uint32_t... TX_PINS
+        > void multi_uart_tx<
+          TIMER,
+          TX_BUFFER_LENGTH,
+          TX_PINS...
+        >::_uart_ctx_::tc_interrupt(
+          uint32_t the_status
+        )
+        {
+          if(!(the_status & TC_SR_CPCS)) return;
+
+          // NOTE: the output was composed on the previous interrupt, 
+          // so all the lanes are updated at the same time, and always
+          // with the same latency from the RC compare
+          tx_pio_p->PIO_ODSR=tx_output;
+
+          // the period of the bit just begun
+          register uint32_t ticks=
+            advance_fixed_ticks(1,fixed_bit_ticks,bit_fraction);
+          if(ticks!=bit_period)
+          { bit_period=ticks; timer_p->set_rc_period(ticks); }
+
+          update_tx_output();
+
+          // once every lane is idle, we stop until there is new data
+          if(!tx_busy)
+          {
+            TC_Stop(timer_p->tc_p,timer_p->channel);
+            tx_status=tx_status_codes::IDLE;
+          }
+        }
+
+        template<
+          timer_ids TIMER,
+          size_t TX_BUFFER_LENGTH,
+          uint32_t... TX_PINS
+        > bool multi_uart_tx<
+          TIMER,
+          TX_BUFFER_LENGTH,
+          TX_PINS...
+        >::_uart_ctx_::set_tx_data(
+          uint32_t port,
+          uint32_t data
+        )
+        {
+          // NOTE: the same framing as the uarts on the core
+          frame_t data_to_send=format.encode(data);
+
+          interrupt_guard guard;
+
+          if(!tx_buffers[port].push(data_to_send))
+            return false; // tx buffer full
+
+          tx_pending=tx_pending | (1<<port_lanes[port]);
+
+          if(tx_status==tx_status_codes::IDLE)
+          {
+            // the start bit is written on the first RC compare
+            update_tx_output();
+            tx_status=tx_status_codes::SENDING;
+
+            // NOTE: the bits are rounded to the nearest from the start
+            bit_fraction=(1<<(TICK_FRACTION_BITS-1));
+            bit_period=advance_fixed_ticks(1,fixed_bit_ticks,bit_fraction);
+            TC_SetRC(timer_p->tc_p,timer_p->channel,bit_period-1);
+            TC_Start(timer_p->tc_p,timer_p->channel);
+          }
+
+          return true;
+        }
+
+      } // namespace arduino_due
+
+    } // namespace soft_uart
+
+  #endif // #ifndef CHIBIOS_PORT
+
+#endif // #ifndef MULTI_UART_H
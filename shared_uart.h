@@ -0,0 +1,881 @@
+/**
+ ** soft_uart library
+ ** Copyright (C) 2015-2020
+ **
+ **   Antonio C. Domínguez Brito <antonio.dominguez@ulpgc.es>
+ **     División de Robótica y Oceanografía Computacional <www.roc.siani.es>
+ **     and Departamento de Informática y Sistemas <www.dis.ulpgc.es>
+ **     Universidad de Las Palmas de Gran  Canaria (ULPGC) <www.ulpgc.es>
+ **
+ ** This file is part of the soft_uart library.
+ ** The soft_uart library is free software: you can redistribute it and/or modify
+ ** it under  the  terms of  the GNU  General  Public  License  as  published  by
+ ** the  Free Software Foundation, either  version  3  of  the  License,  or  any
+ ** later version.
+ **
+ ** The  soft_uart library is distributed in the hope that  it  will  be  useful,
+ ** but   WITHOUT   ANY WARRANTY;   without   even   the  implied   warranty   of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR  PURPOSE.  See  the  GNU  General
+ ** Public License for more details.
+ **
+ ** You should have received a copy  (COPYING file) of  the  GNU  General  Public
+ ** License along with the soft_uart library.
+ ** If not, see: <http://www.gnu.org/licenses/>.
+ **/
+/*
+ * File: shared_uart.h
+ * Description: Software UART ports sharing one timer/counter channel of the
+ * Arduino Due's Atmel ATSAM3X8E, each one with its own serial protocol (bit
+ * rate included), by means of a scheduler of deadlines.
+ * Date: October 17th, 2026
+ * Author: Antonio C. Dominguez-Brito <antonio.dominguez@ulpgc.es>
+ * ROC-SIANI - Universidad de Las Palmas de Gran Canaria - Spain
+ */
+
+#ifndef SHARED_UART_H
+  #define SHARED_UART_H
+
+  #include "soft_uart.h"
+
+  #ifndef CHIBIOS_PORT
+
+    #define shared_uart_scheduler_declaration(id,max_ports) \
+    void TC##id##_Handler(void) \
+    { \
+      uint32_t status=TC_GetStatus( \
+        soft_uart::arduino_due::tc_timer_table[ \
+          static_cast<uint32_t>( \
+            soft_uart::arduino_due::timer_ids::TIMER_TC##id \
+          ) \
+        ].tc_p, \
+        soft_uart::arduino_due::tc_timer_table[ \
+          static_cast<uint32_t>( \
+            soft_uart::arduino_due::timer_ids::TIMER_TC##id \
+          ) \
+        ].channel \
+      ); \
+      \
+      soft_uart::arduino_due::scheduler< \
+        soft_uart::arduino_due::timer_ids::TIMER_TC##id, \
+        max_ports \
+      >::tc_interrupt(status); \
+    } \
+    \
+    typedef soft_uart::arduino_due::scheduler< \
+      soft_uart::arduino_due::timer_ids::TIMER_TC##id, \
+      max_ports \
+    > scheduler_tc##id##_t;
+
+    namespace soft_uart
+    {
+
+      namespace arduino_due
+      {
+
+        enum class deadline_kinds: uint32_t
+        {
+          RX_DEADLINE=0,
+          TX_DEADLINE=1
+        };
+
+        // NOTE: the ports registered on a scheduler are served through
+        // this interface, from the RX pin interrupt (rx_edge()) and 
+        // from the TC interrupt of the scheduler (deadline())
+        class scheduled_port
+        {
+          public:
+
+            virtual ~scheduled_port() {}
+
+            virtual void rx_edge() = 0;
+            virtual void deadline(deadline_kinds kind) = 0;
+        };
+
+        template<typename SCHEDULER,uint32_t SLOT> 
+        void scheduled_rx_interrupt() { SCHEDULER::rx_interrupt(SLOT); }
+
+        // NOTE: attachInterrupt() takes a function without arguments,
+        // so there is one function per port slot
+        template<typename SCHEDULER,uint32_t SLOT> 
+        struct scheduled_rx_interrupts
+        {
+          static void fill(void (**table)(void))
+          {
+            table[SLOT]=&scheduled_rx_interrupt<SCHEDULER,SLOT>;
+            scheduled_rx_interrupts<SCHEDULER,SLOT-1>::fill(table);
+          }
+        };
+
+        template<typename SCHEDULER> 
+        struct scheduled_rx_interrupts<SCHEDULER,0>
+        {
+          static void fill(void (**table)(void))
+          { table[0]=&scheduled_rx_interrupt<SCHEDULER,0>; }
+        };
+
+        // NOTE: the scheduler owns one TC channel, whose counter runs
+        // freely, and keeps the pending deadlines of all its ports 
+        // sorted, RC is always programmed to the earliest one, so there
+        // is only a TC interrupt when some port has something to do
+        template<
+          timer_ids TIMER,
+          size_t MAX_PORTS
+        > class scheduler
+        {
+          static_assert(TIMER<timer_ids::TIMER_IDS,"[ERROR] Bad TC id provided to instantiate template scheduler");
+          static_assert(MAX_PORTS>0,"[ERROR] No ports provided to instantiate template scheduler");
+
+          public:
+
+            scheduler() = delete;
+
+            static timer_ids get_timer() { return TIMER; }
+
+            static size_t get_max_ports() { return MAX_PORTS; }
+
+            // TC ticks per second
+            static uint32_t get_tick_rate() { return (VARIANT_MCK)>>1; }
+
+            static uint32_t get_counter()
+            { 
+              return 
+                _ctx_.timer_p->tc_p->TC_CHANNEL[
+                  _ctx_.timer_p->channel
+                ].TC_CV; 
+            }
+
+            // NOTE: deadlines are absolute values of the free-running
+            // TC counter, so they are compared through their (signed)
+            // difference to survive counter wrap-arounds
+            static bool is_due(uint32_t deadline,uint32_t now)
+            { return (static_cast<int32_t>(now-deadline)>=0); }
+
+            // returns the slot assigned to the port, or -1 if there 
+            // are no free slots
+            static int32_t attach(scheduled_port* port_p)
+            { return _ctx_.attach(port_p); }
+
+            static void detach(int32_t slot) { _ctx_.detach(slot); }
+
+            static void (*get_rx_interrupt(int32_t slot))(void)
+            { return _ctx_.rx_interrupts[slot]; }
+
+            // NOTE: it replaces the pending deadline of the same kind 
+            // of the port, if any, and it must be called from the port 
+            // interrupts or with interrupts disabled
+            static void schedule(
+              int32_t slot,
+              deadline_kinds kind,
+              uint32_t deadline
+            ) { _ctx_.schedule(slot,kind,deadline); }
+
+            static void cancel(int32_t slot,deadline_kinds kind)
+            { _ctx_.cancel(slot,kind); }
+
+            static void tc_interrupt(uint32_t the_status)
+            { _ctx_.tc_interrupt(the_status); }
+
+            static void rx_interrupt(uint32_t slot)
+            { 
+              scheduled_port* port_p=_ctx_.ports[slot];
+              if(port_p) port_p->rx_edge();
+            }
+
+          private:
+
+            struct _scheduler_ctx_
+            {
+              int32_t attach(scheduled_port* port_p);
+              void detach(int32_t slot);
+
+              void schedule(
+                int32_t slot,
+                deadline_kinds kind,
+                uint32_t deadline
+              );
+              void cancel(int32_t slot,deadline_kinds kind);
+
+              void tc_interrupt(uint32_t the_status);
+
+              void remove(int32_t slot,deadline_kinds kind);
+              bool program_next_deadline();
+
+              struct deadline_entry
+              {
+                uint32_t deadline;
+                int32_t slot;
+                deadline_kinds kind;
+              };
+
+              tc_timer_data* timer_p;
+              scheduled_port* ports[MAX_PORTS];
+              void (*rx_interrupts[MAX_PORTS])(void);
+              uint32_t attached;
+
+              // NOTE: at most one RX and one TX deadline per port,
+              // sorted from the earliest to the latest one
+              deadline_entry queue[2*MAX_PORTS];
+              volatile uint32_t queued;
+            };
+
+            static _scheduler_ctx_ _ctx_;
+        };
+
+        template<
+          timer_ids TIMER,
+          size_t MAX_PORTS
+        > typename scheduler<
+          TIMER,
+          MAX_PORTS
+        >::_scheduler_ctx_ scheduler<TIMER,MAX_PORTS>::_ctx_;
+
+        template<
+          timer_ids TIMER,
+          size_t MAX_PORTS
+        > int32_t scheduler<
+          TIMER,
+          MAX_PORTS
+        >::_scheduler_ctx_::attach(
+          scheduled_port* port_p
+        )
+        {
+          interrupt_guard guard;
+
+          if(!attached)
+          {
+            // the first port starts the TC channel
+            timer_p=&(tc_timer_table[static_cast<uint32_t>(TIMER)]);
+            for(uint32_t i=0; i<MAX_PORTS; i++) ports[i]=nullptr;
+            scheduled_rx_interrupts<
+              scheduler<TIMER,MAX_PORTS>,
+              MAX_PORTS-1
+            >::fill(rx_interrupts);
+            queued=0;
+
+            // PMC settings
+            pmc_set_writeprotect(0);
+            pmc_enable_periph_clk(uint32_t(timer_p->irq));
+
+            // the counter runs freely (no reset on RC compare), RC
+            // is used for the next deadline
+            TC_Configure(
+              timer_p->tc_p,
+              timer_p->channel,
+              TC_CMR_TCCLKS_TIMER_CLOCK1 |
+              TC_CMR_WAVE |
+              TC_CMR_WAVSEL_UP
+            );
+            timer_p->tc_p->TC_CHANNEL[timer_p->channel].TC_IDR=TC_IDR_CPCS;
+
+            NVIC_SetPriority(timer_p->irq,0);
+            NVIC_ClearPendingIRQ(timer_p->irq);
+            NVIC_EnableIRQ(timer_p->irq);
+            TC_Start(timer_p->tc_p,timer_p->channel);
+          }
+
+          for(uint32_t slot=0; slot<MAX_PORTS; slot++)
+            if(!ports[slot])
+            {
+              ports[slot]=port_p;
+              attached++;
+              return slot;
+            }
+
+          return -1;
+        }
+
+        template<
+          timer_ids TIMER,
+          size_t MAX_PORTS
+        > void scheduler<
+          TIMER,
+          MAX_PORTS
+        >::_scheduler_ctx_::detach(
+          int32_t slot
+        )
+        {
+          interrupt_guard guard;
+
+          if((slot<0) || (slot>=static_cast<int32_t>(MAX_PORTS)) || !ports[slot]) 
+            return;
+
+          remove(slot,deadline_kinds::RX_DEADLINE);
+          remove(slot,deadline_kinds::TX_DEADLINE);
+          ports[slot]=nullptr;
+
+          if(--attached) { program_next_deadline(); return; }
+
+          // the last port stops the TC channel
+          NVIC_DisableIRQ(timer_p->irq);
+          TC_Stop(timer_p->tc_p,timer_p->channel);
+          pmc_disable_periph_clk(uint32_t(timer_p->irq));
+        }
+
+        template<
+          timer_ids TIMER,
+          size_t MAX_PORTS
+        > void scheduler<
+          TIMER,
+          MAX_PORTS
+        >::_scheduler_ctx_::remove(
+          int32_t slot,
+          deadline_kinds kind
+        )
+        {
+          for(uint32_t i=0; i<queued; i++)
+            if((queue[i].slot==slot) && (queue[i].kind==kind))
+            {
+              for(uint32_t j=i+1; j<queued; j++) queue[j-1]=queue[j];
+              queued--;
+              return;
+            }
+        }
+
+        template<
+          timer_ids TIMER,
+          size_t MAX_PORTS
+        > void scheduler<
+          TIMER,
+          MAX_PORTS
+        >::_scheduler_ctx_::schedule(
+          int32_t slot,
+          deadline_kinds kind,
+          uint32_t deadline
+        )
+        {
+          remove(slot,kind);
+
+          // NOTE: deadlines are sorted by their distance to the counter
+          register uint32_t now=get_counter();
+          register int32_t distance=static_cast<int32_t>(deadline-now);
+
+          register uint32_t i=queued;
+          while(
+            (i>0) && 
+            (static_cast<int32_t>(queue[i-1].deadline-now)>distance)
+          ) { queue[i]=queue[i-1]; i--; }
+
+          queue[i].deadline=deadline; 
+          queue[i].slot=slot; 
+          queue[i].kind=kind;
+          queued++;
+
+          // NOTE: if the earliest deadline is already due, the TC 
+          // interrupt is forced to serve it right away
+          if(!program_next_deadline()) NVIC_SetPendingIRQ(timer_p->irq);
+        }
+
+        template<
+          timer_ids TIMER,
+          size_t MAX_PORTS
+        > void scheduler<
+          TIMER,
+          MAX_PORTS
+        >::_scheduler_ctx_::cancel(
+          int32_t slot,
+          deadline_kinds kind
+        )
+        {
+          interrupt_guard guard;
+
+          remove(slot,kind);
+          program_next_deadline();
+        }
+
+        template<
+          timer_ids TIMER,
+          size_t MAX_PORTS
+        > bool scheduler<
+          TIMER,
+          MAX_PORTS
+        >::_scheduler_ctx_::program_next_deadline()
+        {
+          if(!queued)
+          {
+            timer_p->tc_p->TC_CHANNEL[timer_p->channel].TC_IDR=TC_IDR_CPCS;
+            return true;
+          }
+
+          TC_SetRC(timer_p->tc_p,timer_p->channel,queue[0].deadline);
+          timer_p->tc_p->TC_CHANNEL[timer_p->channel].TC_IER=TC_IER_CPCS;
+
+          // NOTE: if the counter has already gone past the deadline
+          // the RC compare would not happen until the counter wraps
+          // around
+          return !is_due(queue[0].deadline,get_counter());
+        }
+
+        template<
+          timer_ids TIMER,
+          size_t MAX_PORTS
+        > void scheduler<
+          TIMER,
+          MAX_PORTS
+        >::_scheduler_ctx_::tc_interrupt(
+          uint32_t /*the_status*/
+        )
+        {
+          // NOTE: the interrupt may also be forced by schedule(), so
+          // the status is not checked, only the deadlines due
+          do
+          {
+            while(queued && is_due(queue[0].deadline,get_counter()))
+            {
+              deadline_entry entry=queue[0];
+              for(uint32_t j=1; j<queued; j++) queue[j-1]=queue[j];
+              queued--;
+
+              // NOTE: the port may schedule its next deadline here
+              ports[entry.slot]->deadline(entry.kind);
+            }
+          } while(!program_next_deadline());
+        }
+
+        // NOTE: a shared_uart port works like a uart object using the
+        // EDGE_TIMESTAMPS decoder and the RUN_LENGTH encoder, but its 
+        // timing is done by SCHEDULER, so several ports with different 
+        // bit rates can share its TC channel
+        template<
+          typename SCHEDULER,
+          size_t RX_BUFFER_LENGTH,
+          size_t TX_BUFFER_LENGTH
+        > class shared_uart
+        {
+          public:
+
+            shared_uart() { _ctx_.slot=-1; }
+
+            ~shared_uart() { end(); }
+
+            shared_uart(const shared_uart&) = delete;
+            shared_uart(shared_uart&&) = delete;
+            shared_uart& operator=(const shared_uart&) = delete;
+            shared_uart& operator=(shared_uart&&) = delete;
+
+            return_codes config(
+              uint32_t rx_pin = default_pins::DEFAULT_RX_PIN,
+              uint32_t tx_pin = default_pins::DEFAULT_TX_PIN,
+              uint32_t bit_rate = bit_rates::DEFAULT_BIT_RATE,
+              data_bit_codes the_data_bits = data_bit_codes::EIGHT_BITS,
+              parity_codes the_parity = parity_codes::EVEN_PARITY,
+              stop_bit_codes the_stop_bits = stop_bit_codes::ONE_STOP_BIT
+            )
+            {
+              end();
+
+              return _ctx_.config(
+                rx_pin,
+                tx_pin,
+                bit_rate,
+                the_data_bits,
+                the_parity,
+                the_stop_bits
+              );
+            }
+
+            void end() { _ctx_.end(); }
+
+            int32_t get_slot() { return _ctx_.slot; }
+
+            size_t get_rx_buffer_length() { return RX_BUFFER_LENGTH; }
+            size_t get_tx_buffer_length() { return TX_BUFFER_LENGTH; }
+
+            uint32_t get_bit_rate() { return _ctx_.bit_rate; }
+            double get_bit_time() { return double(1)/double(_ctx_.bit_rate); }
+            double get_frame_time() 
+            { 
+              return 
+                double(_ctx_.format.tx_frame_bits)/double(_ctx_.bit_rate); 
+            }
+
+            int available() { return _ctx_.available(); }
+
+            uint32_t get_rx_data(uint32_t& data) 
+            { return _ctx_.get_rx_data(data); }
+
+            // NOTE: it returns the number of frames read (up to length), 
+            // without waiting, with their data on data (8 bits at most), 
+            // and their status on statuses (if given)
+            size_t get_rx_data(
+              uint8_t* data,
+              size_t length,
+              uint32_t* statuses = nullptr
+            ) { return _ctx_.get_rx_data(data,length,statuses); }
+
+            bool data_available(uint32_t status)
+            { return _ctx_.data_available(status); }
+
+            bool data_lost(uint32_t status)
+            { return _ctx_.data_lost(status); }
+
+            bool bad_status(uint32_t status)
+            { return _ctx_.bad_status(status); }
+
+            bool bad_start_bit(uint32_t status)
+            { return _ctx_.bad_start_bit(status); }
+
+            bool bad_parity(uint32_t status)
+            { return _ctx_.bad_parity(status); }
+
+            bool bad_stop_bit(uint32_t status)
+            { return _ctx_.bad_stop_bit(status); }
+
+            // is TX buffer full?
+            bool is_tx_full() { return _ctx_.is_tx_full(); }
+
+            int available_for_write() { return _ctx_.available_for_write(); }
+
+            // NOTE: data is 5, 6, 7, 8 or 9 bits length
+            bool set_tx_data(uint32_t data)
+            { return (_ctx_.slot>=0)? _ctx_.set_tx_data(data): false; }
+
+            // NOTE: it returns the number of frames pushed, without 
+            // waiting for room on the TX buffer
+            size_t set_tx_data(const uint8_t* data,size_t length)
+            { return (_ctx_.slot>=0)? _ctx_.set_tx_data(data,length): 0; }
+
+            tx_status_codes get_tx_status() { return _ctx_.get_tx_status(); }
+
+            // NOTE: a copy taken with interrupts disabled
+            link_statistics get_link_statistics()
+            { interrupt_guard guard; return _ctx_.statistics; }
+
+            void reset_link_statistics()
+            { interrupt_guard guard; _ctx_.statistics.reset(); }
+
+            void flush() { _ctx_.flush(); }
+
+            void flush_rx() { _ctx_.flush_rx(); }
+
+          private:
+
+            // NOTE: the longest valid frame (start bit, 9 data bits,
+            // parity and stop bit) has 12 edges at most, the rest
+            // is margin for glitches
+            static constexpr uint32_t MAX_RX_EDGES=16;
+
+            // NOTE: the deadline engine of the scheduler on the uart core
+            struct _uart_ctx_: 
+              uart_core<
+                _uart_ctx_,
+                RX_BUFFER_LENGTH,
+                TX_BUFFER_LENGTH,
+                runtime_frame_format
+              >,
+              scheduled_port
+            {
+              typedef uart_core<
+                _uart_ctx_,
+                RX_BUFFER_LENGTH,
+                TX_BUFFER_LENGTH,
+                runtime_frame_format
+              > core;
+
+              SOFT_UART_USING_CORE_NAMES;
+
+              return_codes config(
+                uint32_t the_rx_pin,
+                uint32_t the_tx_pin,
+                uint32_t the_bit_rate,
+                data_bit_codes the_data_bits,
+                parity_codes the_parity,
+                stop_bit_codes the_stop_bits
+              );
+
+              void end()
+              {
+                if(slot<0) return;
+
+                flush();
+                detachInterrupt(rx_pin);
+                SCHEDULER::detach(slot);
+                slot=-1;
+              }
+
+              void flush()
+              {
+                // wait until sending everything
+                while(tx_status!=tx_status_codes::IDLE)
+                { busy_wait(); }
+              }
+
+              // NOTE: from set_tx_data() of the core
+              void start_tx();
+
+              void rx_edge() override;
+              void deadline(deadline_kinds kind) override;
+
+              void set_outgoing_bit()
+              {
+                if((tx_data>>tx_bit_counter) & 1)
+                  PIO_Set(tx_pio_p,tx_mask);
+                else PIO_Clear(tx_pio_p,tx_mask);
+              }
+
+              // number of bits from tx_bit_counter up to the next line 
+              // transition, or up to the end of the frame
+              uint32_t get_outgoing_run()
+              {
+                register uint32_t bits=tx_data>>tx_bit_counter;
+
+                // NOTE: the bits beyond the stop bits are zero, so a 
+                // run of ones always ends at the end of the frame
+                return static_cast<uint32_t>(
+                  __builtin_ctz((bits & 1)? ~bits: bits)
+                );
+              }
+
+              // NOTE: the fraction of tick is carried over to the next
+              // deadline, so the deadlines do not drift 
+              void advance_tx_deadline(uint32_t bits)
+              {
+                uint32_t fraction=tx_deadline_fraction;
+
+                tx_deadline=tx_deadline+
+                  advance_fixed_ticks(bits,fixed_bit_ticks,fraction);
+                tx_deadline_fraction=fraction;
+              }
+
+              void decode_rx_edges();
+
+              int32_t slot;
+
+              uint32_t rx_pin;
+              Pio* rx_pio_p;
+              uint32_t rx_mask;
+
+              uint32_t tx_pin;
+              Pio* tx_pio_p;
+              uint32_t tx_mask;
+
+              uint32_t fixed_bit_ticks;
+              uint32_t bit_1st_quarter;
+
+              uint32_t bit_rate;
+
+              // rx data
+              uint32_t rx_edge_ticks[MAX_RX_EDGES];
+              volatile uint32_t rx_edge_levels;
+              volatile uint32_t rx_edges;
+              uint32_t rx_frame_ticks;
+
+              // tx data
+              volatile uint32_t tx_deadline;
+              volatile uint32_t tx_deadline_fraction;
+            };
+
+            _uart_ctx_ _ctx_;
+        };
+
+        template<
+          typename SCHEDULER,
+          size_t RX_BUFFER_LENGTH,
+          size_t TX_BUFFER_LENGTH
+        > return_codes shared_uart<
+          SCHEDULER,
+          RX_BUFFER_LENGTH,
+          TX_BUFFER_LENGTH
+        >::_uart_ctx_::config(
+          uint32_t the_rx_pin,
+          uint32_t the_tx_pin,
+          uint32_t the_bit_rate,
+          data_bit_codes the_data_bits,
+          parity_codes the_parity,
+          stop_bit_codes the_stop_bits
+        )
+        {
+          if(
+            (the_bit_rate<bit_rates::MIN_BIT_RATE) ||
+            (the_bit_rate>bit_rates::MAX_BIT_RATE)
+          ) return return_codes::BAD_BIT_RATE_ERROR;
+
+          if(the_rx_pin>=NUM_DIGITAL_PINS) return return_codes::BAD_RX_PIN;
+
+          if(the_tx_pin>=NUM_DIGITAL_PINS) return return_codes::BAD_TX_PIN;
+
+          bit_rate=the_bit_rate;
+          fixed_bit_ticks=
+            get_fixed_bit_ticks(SCHEDULER::get_tick_rate(),bit_rate);
+
+          bit_1st_quarter=(fixed_bit_ticks+(1<<(TICK_FRACTION_BITS+1)))>>
+            (TICK_FRACTION_BITS+2);
+
+          format.set(the_data_bits,the_parity,the_stop_bits);
+          reset_engine();
+
+          // ticks from the start bit edge to the middle of the stop bit
+          rx_frame_ticks=
+            get_half_bit_ticks(fixed_bit_ticks,(format.rx_frame_bits<<1)-1);
+
+          rx_pin=the_rx_pin;
+          rx_pio_p=g_APinDescription[rx_pin].pPort;
+          rx_mask=g_APinDescription[rx_pin].ulPin;
+          rx_edges=0;
+
+          tx_pin=the_tx_pin;
+          tx_pio_p=g_APinDescription[tx_pin].pPort;
+          tx_mask=g_APinDescription[tx_pin].ulPin;
+
+          slot=SCHEDULER::attach(this);
+          if(slot<0) return return_codes::NO_FREE_PORT_SLOT;
+
+          // cofigure tx pin
+          pinMode(tx_pin,OUTPUT);
+          digitalWrite(tx_pin,HIGH);
+
+          // configure & attatch interrupt on rx pin
+          pinMode(rx_pin,INPUT_PULLUP);
+          attachInterrupt(rx_pin,SCHEDULER::get_rx_interrupt(slot),CHANGE);
+
+          return return_codes::EVERYTHING_OK;
+        }
+
+        template<
+          typename SCHEDULER,
+          size_t RX_BUFFER_LENGTH,
+          size_t TX_BUFFER_LENGTH
+        > void shared_uart<
+          SCHEDULER,
+          RX_BUFFER_LENGTH,
+          TX_BUFFER_LENGTH
+        >::_uart_ctx_::rx_edge()
+        {
+          register uint32_t now=SCHEDULER::get_counter();
+          register uint32_t level=
+            (PIO_Get(rx_pio_p,PIO_INPUT,rx_mask))? 1: 0;
+
+          switch(rx_status)
+          {
+            case rx_status_codes::LISTENING:
+              if(!level)
+              {
+                rx_status=rx_status_codes::RECEIVING;
+                rx_edge_ticks[0]=now; rx_edge_levels=0; rx_edges=1;
+                SCHEDULER::schedule(
+                  slot,
+                  deadline_kinds::RX_DEADLINE,
+                  now+rx_frame_ticks
+                );
+              }
+              break;
+
+            case rx_status_codes::RECEIVING:
+              if(rx_edges<MAX_RX_EDGES)
+              {
+                rx_edge_ticks[rx_edges]=now;
+                rx_edge_levels|=(level<<rx_edges);
+                rx_edges++;
+              }
+              break;
+          }
+        }
+
+        template<
+          typename SCHEDULER,
+          size_t RX_BUFFER_LENGTH,
+          size_t TX_BUFFER_LENGTH
+        > void shared_uart<
+          SCHEDULER,
+          RX_BUFFER_LENGTH,
+          TX_BUFFER_LENGTH
+        >::_uart_ctx_::deadline(
+          deadline_kinds kind
+        )
+        {
+          if(kind==deadline_kinds::RX_DEADLINE)
+          {
+            decode_rx_edges();
+            rx_status=rx_status_codes::LISTENING;
+            return;
+          }
+
+          if(tx_bit_counter>=format.tx_frame_bits)
+          {
+            frame_t data_to_send;
+            if(!pop_tx_frame(data_to_send))
+            { tx_status=tx_status_codes::IDLE; return; }
+
+            tx_data=data_to_send; tx_bit_counter=0;
+          }
+
+          // NOTE: the line keeps its level up to the next transition, 
+          // so that is the next deadline
+          register uint32_t bits=get_outgoing_run();
+
+          set_outgoing_bit();
+          tx_bit_counter=tx_bit_counter+bits;
+          advance_tx_deadline(bits);
+
+          SCHEDULER::schedule(slot,deadline_kinds::TX_DEADLINE,tx_deadline);
+        }
+
+        template<
+          typename SCHEDULER,
+          size_t RX_BUFFER_LENGTH,
+          size_t TX_BUFFER_LENGTH
+        > void shared_uart<
+          SCHEDULER,
+          RX_BUFFER_LENGTH,
+          TX_BUFFER_LENGTH
+        >::_uart_ctx_::decode_rx_edges()
+        {
+          // NOTE: each bit is sampled at its middle, taking the level
+          // set by the last edge before it, edge 0 is the start bit
+          register uint32_t start=rx_edge_ticks[0];
+          register uint32_t edge=0;
+          register uint32_t level=0;
+          register uint32_t data=0;
+
+          for(uint32_t bit=0; bit<format.rx_frame_bits; bit++)
+          {
+            while(
+              (edge+1<rx_edges) && 
+              (
+                rx_edge_ticks[edge+1]-start<=
+                  get_bit_sample_ticks(fixed_bit_ticks,bit)
+              )
+            ) edge++;
+
+            level=(rx_edge_levels>>edge)&1;
+            data|=(level<<bit);
+          }
+
+          if(format.stop_bits==stop_bit_codes::TWO_STOP_BITS)
+            data|=(level<<format.rx_frame_bits);
+
+          // NOTE: validated and counted on the statistics by the core
+          push_rx_frame(data);
+        }
+
+        template<
+          typename SCHEDULER,
+          size_t RX_BUFFER_LENGTH,
+          size_t TX_BUFFER_LENGTH
+        > void shared_uart<
+          SCHEDULER,
+          RX_BUFFER_LENGTH,
+          TX_BUFFER_LENGTH
+        >::_uart_ctx_::start_tx()
+        {
+          // NOTE: the transmission is only kicked off when idle, 
+          // otherwise the scheduler pops the data just pushed
+          if(tx_status!=tx_status_codes::IDLE) return;
+
+          interrupt_guard guard;
+
+          // NOTE: tx_bit_counter at the end of the frame makes the 
+          // first deadline pop the data just pushed 
+          tx_bit_counter=format.tx_frame_bits;
+          tx_deadline=SCHEDULER::get_counter()+bit_1st_quarter;
+          tx_deadline_fraction=0;
+          tx_status=tx_status_codes::SENDING;
+          SCHEDULER::schedule(slot,deadline_kinds::TX_DEADLINE,tx_deadline);
+        }
+
+      } // namespace arduino_due
+
+    } // namespace soft_uart
+
+  #endif // #ifndef CHIBIOS_PORT
+
+#endif // #ifndef SHARED_UART_H
@@ -36,6 +36,7 @@
   #define SOFT_UART_H
 
   #include <cstdint>
+  #include <type_traits>
     
   #include "fifo.h"
 
@@ -55,7 +56,11 @@
       BAD_BIT_RATE_ERROR=-1,
       BAD_RX_PIN=-2,
       BAD_TX_PIN=-3,
-      BAD_HALF_DUPLEX_PIN=-4
+      BAD_HALF_DUPLEX_PIN=-4,
+      BAD_CAPTURE_PIN=-5,
+      BAD_TX_ENCODER=-6,
+      BAD_WAVEFORM_PIN=-7,
+      NO_FREE_PORT_SLOT=-8
     };
     
     enum class data_bit_codes: uint32_t
@@ -94,6 +99,7 @@
       BAD_START_BIT=4,
       BAD_PARITY=8,
       BAD_STOP_BIT=16,
+      IDLE_LINE=32 // packet boundary, the line was idle after a frame
     };
     
     enum class tx_status_codes: uint32_t
@@ -109,17 +115,1195 @@
       RX_MODE=1,
       TX_MODE=2
     };
+
+    // NOTE: OVERSAMPLING samples the RX line four times per bit
+    // with the timer, EDGE_TIMESTAMPS timestamps each RX edge with
+    // a free-running timer counter and rebuilds the frame from the
+    // edge intervals once the stop bit is reached, INPUT_CAPTURE
+    // does the same but with edges timestamped by the timer hardware
+    enum class rx_decoder_codes: uint32_t
+    {
+      OVERSAMPLING=0,
+      EDGE_TIMESTAMPS=1,
+      INPUT_CAPTURE=2
+    };
+
+    // NOTE: PER_BIT updates the TX line on each bit, RUN_LENGTH
+    // only on each line transition, programming the timer to the
+    // next one (it needs the timer running freely, that is, it 
+    // can not be used together with rx_decoder_codes::OVERSAMPLING),
+    // WAVEFORM is like RUN_LENGTH but the transitions are driven by
+    // the timer compare output itself, so they are jitter free
+    enum class tx_encoder_codes: uint32_t
+    {
+      PER_BIT=0,
+      RUN_LENGTH=1,
+      WAVEFORM=2
+    };
+
+    // NOTE: the longest frame (start bit, 9 data bits, parity and
+    // two stop bits) has 13 bits
+    static constexpr uint32_t MAX_FRAME_BITS=13;
+
+    // NOTE: the smallest unsigned type for frames of BITS bits, RX
+    // and TX buffers store raw frames of type frame_t
+    template<uint32_t BITS>
+    struct frame_storage
+    {
+      typedef typename std::conditional<
+        (BITS<=8),
+        uint8_t,
+        typename std::conditional<(BITS<=16),uint16_t,uint32_t>::type
+      >::type type;
+    };
+
+    typedef frame_storage<MAX_FRAME_BITS>::type frame_t;
+
+    // NOTE: the bulk reads pop the frames from the RX buffer in chunks
+    // of RX_CHUNK_FRAMES at most, validating each chunk on the stack
+    static constexpr size_t RX_CHUNK_FRAMES=16;
+
+    // NOTE: the mark put on the RX buffer when the line gets idle after
+    // a frame (it is not a frame, as frames are shorter)
+    static constexpr frame_t RX_IDLE_MARK=static_cast<frame_t>(1<<15);
+    static_assert(
+      MAX_FRAME_BITS<15,
+      "RX_IDLE_MARK must not be a valid frame"
+    );
+
+    // NOTE: the parity bit making even the number of ones on the bits
+    // least significant bits of data, folding them in constant time 
+    // (0x6996 is the parity of each nibble value)
+    inline uint32_t get_even_parity(uint32_t data,uint32_t bits)
+    {
+      data&=(bits<32)? (1u<<bits)-1: 0xFFFFFFFF;
+      data^=data>>16; data^=data>>8; data^=data>>4;
+      return (0x6996>>(data&0xF))&1;
+    }
+
+    #define SOFT_UART_FRAME_TABLE_4(n) \
+      encode(n), encode(n+1), encode(n+2), encode(n+3)
+    #define SOFT_UART_FRAME_TABLE_16(n) \
+      SOFT_UART_FRAME_TABLE_4(n), SOFT_UART_FRAME_TABLE_4(n+4), \
+      SOFT_UART_FRAME_TABLE_4(n+8), SOFT_UART_FRAME_TABLE_4(n+12)
+    #define SOFT_UART_FRAME_TABLE_64(n) \
+      SOFT_UART_FRAME_TABLE_16(n), SOFT_UART_FRAME_TABLE_16(n+16), \
+      SOFT_UART_FRAME_TABLE_16(n+32), SOFT_UART_FRAME_TABLE_16(n+48)
+    #define SOFT_UART_FRAME_TABLE_256(n) \
+      SOFT_UART_FRAME_TABLE_64(n), SOFT_UART_FRAME_TABLE_64(n+64), \
+      SOFT_UART_FRAME_TABLE_64(n+128), SOFT_UART_FRAME_TABLE_64(n+192)
+
+    // NOTE: the frames (start bit, data, parity and stop bits) for the 
+    // 256 values of 8 data bits with parity, computed at compile time,
+    // so encoding a frame is a single lookup (512 bytes of flash for 
+    // each parity and stop bits combination actually used)
+    template<parity_codes PARITY,stop_bit_codes STOP_BITS>
+    struct frame_table_8
+    {
+      static constexpr frame_t encode(uint32_t data)
+      {
+        return static_cast<frame_t>(
+          (data<<1) |
+          (
+            (
+              ((0x6996>>((data^(data>>4))&0xF))&1) ^ 
+              ((PARITY==parity_codes::ODD_PARITY)? 1: 0)
+            )<<9
+          ) |
+          (((STOP_BITS==stop_bit_codes::TWO_STOP_BITS)? 0x3: 0x1)<<10)
+        );
+      }
+
+      static const frame_t table[256];
+    };
+
+    template<parity_codes PARITY,stop_bit_codes STOP_BITS>
+    const frame_t frame_table_8<PARITY,STOP_BITS>::table[256]=
+    { SOFT_UART_FRAME_TABLE_256(0) };
+
+    #undef SOFT_UART_FRAME_TABLE_256
+    #undef SOFT_UART_FRAME_TABLE_64
+    #undef SOFT_UART_FRAME_TABLE_16
+    #undef SOFT_UART_FRAME_TABLE_4
+
+    // NOTE: the serial protocol of a uart (frame format) is set at 
+    // runtime when configuring it (runtime_frame_format), or at compile
+    // time (frame_format), then all its fields are constant, and the
+    // format arguments of the configuration functions are ignored
+    struct runtime_frame_format
+    {
+      void set(
+        data_bit_codes the_data_bits,
+        parity_codes the_parity,
+        stop_bit_codes the_stop_bits
+      )
+      {
+        data_bits=the_data_bits; parity=the_parity; stop_bits=the_stop_bits;
+    
+        // reception frame length in bits
+        rx_frame_bits=1 + // the start bit
+          static_cast<uint32_t>(data_bits) + // the data bits
+          ((parity!=parity_codes::NO_PARITY)? 1: 0) + // the parity?
+          1; // for reception we ONLY consider one stop bit
+    
+        // transmission frame length in bits
+        tx_frame_bits=rx_frame_bits;
+        if(stop_bits==stop_bit_codes::TWO_STOP_BITS) 
+        {
+          // for transmission we DO consider also the second stop bit
+          tx_frame_bits++; 
+        }
+    
+        parity_bit_pos=1 + // the start bit
+          static_cast<uint32_t>(data_bits); // the data bits
+    
+        first_stop_bit_pos=parity_bit_pos +
+          ((parity!=parity_codes::NO_PARITY)? 1: 0); // the parity?
+    
+        data_mask=(1<<static_cast<uint32_t>(data_bits))-1;
+
+        // NOTE: 8 data bits with parity are encoded with the table of
+        // their parity and stop bits (as the format is only known at 
+        // runtime, the four tables end up in flash, 2 KB)
+        frame_table=nullptr;
+        if(
+          (data_bits==data_bit_codes::EIGHT_BITS) && 
+          (parity!=parity_codes::NO_PARITY)
+        )
+          frame_table=(parity==parity_codes::EVEN_PARITY)?
+            (
+              (stop_bits==stop_bit_codes::ONE_STOP_BIT)?
+                frame_table_8<
+                  parity_codes::EVEN_PARITY,
+                  stop_bit_codes::ONE_STOP_BIT
+                >::table:
+                frame_table_8<
+                  parity_codes::EVEN_PARITY,
+                  stop_bit_codes::TWO_STOP_BITS
+                >::table
+            ):
+            (
+              (stop_bits==stop_bit_codes::ONE_STOP_BIT)?
+                frame_table_8<
+                  parity_codes::ODD_PARITY,
+                  stop_bit_codes::ONE_STOP_BIT
+                >::table:
+                frame_table_8<
+                  parity_codes::ODD_PARITY,
+                  stop_bit_codes::TWO_STOP_BITS
+                >::table
+            );
+      }
+
+      // the frame to send for data
+      frame_t encode(uint32_t data)
+      {
+        if(frame_table) return frame_table[data&0xFF];
+
+        data&=data_mask;
+
+        uint32_t frame=(data<<1)|(
+          ((stop_bits==stop_bit_codes::ONE_STOP_BIT)? 0x1: 0x3)<<
+            first_stop_bit_pos
+        );
+
+        if(parity!=parity_codes::NO_PARITY)
+          frame|=(
+            get_even_parity(data,static_cast<uint32_t>(data_bits))^
+              ((parity==parity_codes::ODD_PARITY)? 1: 0)
+          )<<parity_bit_pos;
+
+        return static_cast<frame_t>(frame);
+      }
+
+      data_bit_codes data_bits;
+      parity_codes parity;
+      stop_bit_codes stop_bits;
+      uint32_t rx_frame_bits;
+      uint32_t tx_frame_bits;
+      uint32_t parity_bit_pos;
+      uint32_t first_stop_bit_pos;
+      uint32_t data_mask;
+      const frame_t* frame_table; // null if not encoded with a table
+    };
+
+    template<
+      data_bit_codes DATA_BITS,
+      parity_codes PARITY,
+      stop_bit_codes STOP_BITS
+    > struct frame_format
+    {
+      void set(data_bit_codes,parity_codes,stop_bit_codes) {}
+
+      // NOTE: 8 data bits with parity are encoded with a table
+      static frame_t encode(uint32_t data)
+      {
+        return _encode_(
+          data,
+          bool_to_type<
+            (DATA_BITS==data_bit_codes::EIGHT_BITS) && 
+            (PARITY!=parity_codes::NO_PARITY)
+          >()
+        );
+      }
+
+      static constexpr data_bit_codes data_bits=DATA_BITS;
+      static constexpr parity_codes parity=PARITY;
+      static constexpr stop_bit_codes stop_bits=STOP_BITS;
+      static constexpr uint32_t rx_frame_bits=1 + 
+        static_cast<uint32_t>(DATA_BITS) + 
+        ((PARITY!=parity_codes::NO_PARITY)? 1: 0) + 
+        1;
+      static constexpr uint32_t tx_frame_bits=rx_frame_bits + 
+        ((STOP_BITS==stop_bit_codes::TWO_STOP_BITS)? 1: 0);
+      static constexpr uint32_t parity_bit_pos=1 + 
+        static_cast<uint32_t>(DATA_BITS);
+      static constexpr uint32_t first_stop_bit_pos=parity_bit_pos + 
+        ((PARITY!=parity_codes::NO_PARITY)? 1: 0);
+      static constexpr uint32_t data_mask=
+        (1<<static_cast<uint32_t>(DATA_BITS))-1;
+
+    private:
+
+      static frame_t _encode_(uint32_t data,bool_to_type<true>)
+      { return frame_table_8<PARITY,STOP_BITS>::table[data&0xFF]; }
+
+      static frame_t _encode_(uint32_t data,bool_to_type<false>)
+      {
+        data&=data_mask;
+
+        uint32_t frame=(data<<1)|(
+          ((STOP_BITS==stop_bit_codes::ONE_STOP_BIT)? 0x1: 0x3)<<
+            first_stop_bit_pos
+        );
+
+        if(PARITY!=parity_codes::NO_PARITY)
+          frame|=(
+            get_even_parity(data,static_cast<uint32_t>(DATA_BITS))^
+              ((PARITY==parity_codes::ODD_PARITY)? 1: 0)
+          )<<parity_bit_pos;
+
+        return static_cast<frame_t>(frame);
+      }
+    };
+
+    template<data_bit_codes D,parity_codes P,stop_bit_codes S>
+    constexpr data_bit_codes frame_format<D,P,S>::data_bits;
+    template<data_bit_codes D,parity_codes P,stop_bit_codes S>
+    constexpr parity_codes frame_format<D,P,S>::parity;
+    template<data_bit_codes D,parity_codes P,stop_bit_codes S>
+    constexpr stop_bit_codes frame_format<D,P,S>::stop_bits;
+    template<data_bit_codes D,parity_codes P,stop_bit_codes S>
+    constexpr uint32_t frame_format<D,P,S>::rx_frame_bits;
+    template<data_bit_codes D,parity_codes P,stop_bit_codes S>
+    constexpr uint32_t frame_format<D,P,S>::tx_frame_bits;
+    template<data_bit_codes D,parity_codes P,stop_bit_codes S>
+    constexpr uint32_t frame_format<D,P,S>::parity_bit_pos;
+    template<data_bit_codes D,parity_codes P,stop_bit_codes S>
+    constexpr uint32_t frame_format<D,P,S>::first_stop_bit_pos;
+    template<data_bit_codes D,parity_codes P,stop_bit_codes S>
+    constexpr uint32_t frame_format<D,P,S>::data_mask;
+
+    typedef frame_format<
+      data_bit_codes::EIGHT_BITS,
+      parity_codes::NO_PARITY,
+      stop_bit_codes::ONE_STOP_BIT
+    > frame_format_8N1;
+
+    typedef frame_format<
+      data_bit_codes::EIGHT_BITS,
+      parity_codes::EVEN_PARITY,
+      stop_bit_codes::ONE_STOP_BIT
+    > frame_format_8E1;
+
+    typedef frame_format<
+      data_bit_codes::EIGHT_BITS,
+      parity_codes::ODD_PARITY,
+      stop_bit_codes::ONE_STOP_BIT
+    > frame_format_8O1;
+
+    // NOTE: bit lengths are kept in fixed point (24.8 ticks), the 
+    // fraction of tick of each bit is accumulated instead of being
+    // truncated, so the bit positions do not drift along the frame, 
+    // and only integer arithmetic is used (no soft-float on the DUE)
+    static constexpr uint32_t TICK_FRACTION_BITS=8;
+    static constexpr uint32_t TICK_FRACTION_MASK=
+      (1<<TICK_FRACTION_BITS)-1;
+
+    // fixed point ticks of a bit, rounded to the nearest
+    inline uint32_t get_fixed_bit_ticks(
+      uint32_t tick_rate,
+      uint32_t bit_rate
+    )
+    {
+      return 
+        ((tick_rate/bit_rate)<<TICK_FRACTION_BITS) + 
+        (
+          ((tick_rate%bit_rate)<<TICK_FRACTION_BITS) + (bit_rate>>1)
+        )/bit_rate;
+    }
+
+    // ticks (rounded to the nearest) from the start of the frame to 
+    // the given number of half bits
+    inline uint32_t get_half_bit_ticks(
+      uint32_t fixed_bit_ticks,
+      uint32_t half_bits
+    )
+    { 
+      return 
+        (half_bits*fixed_bit_ticks + (1<<TICK_FRACTION_BITS))>>
+          (TICK_FRACTION_BITS+1); 
+    }
+
+    // whole ticks from a deadline to the next one, the given number of 
+    // bits later, the fraction of tick left is carried over in fraction
+    inline uint32_t advance_fixed_ticks(
+      uint32_t bits,
+      uint32_t fixed_bit_ticks,
+      uint32_t& fraction
+    )
+    {
+      register uint32_t ticks=fraction+bits*fixed_bit_ticks;
+
+      fraction=ticks&TICK_FRACTION_MASK;
+      return ticks>>TICK_FRACTION_BITS;
+    }
+
+    // NOTE: a quarter of the fixed point ticks of a bit is exact with
+    // two more fraction bits, so the whole ticks of the quarters of bit
+    // alternate between the floor and the ceil of a quarter, carrying
+    // over the fraction of tick left (in 1/1024 of tick), and any four
+    // consecutive quarters make up a bit
+    inline uint32_t advance_quarter_ticks(
+      uint32_t fixed_bit_ticks,
+      uint32_t& fraction
+    )
+    {
+      register uint32_t ticks=fraction+fixed_bit_ticks;
+
+      fraction=ticks&((TICK_FRACTION_MASK<<2)|0x3);
+      return ticks>>(TICK_FRACTION_BITS+2);
+    }
+
+    // ticks (truncated) from the start of the frame to the middle of 
+    // the given bit, the start bit is bit 0
+    inline uint32_t get_bit_sample_ticks(
+      uint32_t fixed_bit_ticks,
+      uint32_t bit
+    )
+    {
+      return 
+        ((fixed_bit_ticks>>1)+bit*fixed_bit_ticks)>>TICK_FRACTION_BITS;
+    }
+
+    // NOTE: cumulative counters of a uart since it was configured (or 
+    // since they were reset), frames are counted as sent when their 
+    // transmission starts, and bad frames when they are received 
+    // (whether they are read or not)
+    struct link_statistics
+    {
+      link_statistics() { reset(); }
+
+      void reset()
+      {
+        frames_received=0; frames_sent=0;
+        bad_start_bits=0; bad_parities=0; bad_stop_bits=0;
+        overruns=0; tx_full_rejections=0; rx_high_water_mark=0;
+        tx_aborted_frames=0;
+      }
+
+      uint32_t frames_received;
+      uint32_t frames_sent;
+      uint32_t bad_start_bits;
+      uint32_t bad_parities;
+      uint32_t bad_stop_bits;
+      uint32_t overruns; // frames overwritten on the full RX buffer
+      uint32_t tx_full_rejections; // set_tx_data() with the TX buffer full
+      uint32_t rx_high_water_mark; // most frames ever on the RX buffer
+      uint32_t tx_aborted_frames; // frames sent cut off by a missed edge
+    };
+
+    #ifdef SOFT_UART_ISR_PROFILING
+
+      // NOTE: bin i of the histogram counts the handler invocations 
+      // taking from 2^i to 2^(i+1)-1 cycles, the last one also counts
+      // the longer ones
+      static constexpr uint32_t ISR_PROFILE_BINS=16;
+
+      // cycles spent on each invocation of an interrupt handler
+      struct isr_profile
+      {
+        isr_profile() { reset(); }
+
+        void reset()
+        {
+          min=0xFFFFFFFF; max=0; sum=0; count=0;
+          for(uint32_t i=0; i<ISR_PROFILE_BINS; i++) histogram[i]=0;
+        }
+
+        void add(uint32_t cycles)
+        {
+          if(cycles<min) min=cycles;
+          if(cycles>max) max=cycles;
+          sum+=cycles; count++;
+
+          uint32_t bin=31-__builtin_clz(cycles|1);
+          histogram[(bin<ISR_PROFILE_BINS)? bin: ISR_PROFILE_BINS-1]++;
+        }
+
+        uint32_t get_mean() 
+        { return (count)? static_cast<uint32_t>(sum/count): 0; }
+
+        uint32_t min;
+        uint32_t max;
+        uint64_t sum;
+        uint32_t count;
+        uint32_t histogram[ISR_PROFILE_BINS];
+      };
+
+    #endif // SOFT_UART_ISR_PROFILING
+
+    // NOTE: the errors of a frame received (start bit, parity and stop
+    // bit) with DATA_AVAILABLE, only the first stop bit is verified
+    inline uint32_t check_frame(
+      frame_t frame,
+      data_bit_codes data_bits,
+      parity_codes parity,
+      uint32_t parity_bit_pos,
+      uint32_t first_stop_bit_pos
+    )
+    {
+      register uint32_t status=rx_data_status_codes::DATA_AVAILABLE;
+
+      // checking start bit
+      if(frame & 1) status=status|rx_data_status_codes::BAD_START_BIT;
+  
+      // cheking parity
+      if(parity!=parity_codes::NO_PARITY)
+      {
+        register uint32_t data_parity=get_even_parity(
+          (frame>>1),
+          static_cast<uint32_t>(data_bits)
+        );
+  
+        if(parity==parity_codes::ODD_PARITY) data_parity=data_parity^1;
+  
+        // verifying parity bit
+        if(((frame>>parity_bit_pos) & 1)^data_parity) 
+          status=status|rx_data_status_codes::BAD_PARITY;
+      }
+  
+      // checking stop bit
+      if(!((frame>>first_stop_bit_pos) & 1)) 
+        status=status|rx_data_status_codes::BAD_STOP_BIT;
+
+      return status;
+    }
+
+    // NOTE: from the interrupt handlers of any engine, the frame is 
+    // validated with its format and counted on statistics as it is 
+    // pushed on the RX buffer, it returns its status (DATA_AVAILABLE, 
+    // or DATA_LOST if it overwrote the oldest one, with the errors 
+    // found)
+    template<typename FRAME_FORMAT,typename RX_BUFFER>
+    inline uint32_t store_rx_frame(
+      const FRAME_FORMAT& format,
+      RX_BUFFER& rx_buffer,
+      link_statistics& statistics,
+      frame_t frame
+    )
+    {
+      register uint32_t status=check_frame(
+        frame,
+        format.data_bits,
+        format.parity,
+        format.parity_bit_pos,
+        format.first_stop_bit_pos
+      );
+
+      if(!rx_buffer.push(frame))
+      {
+        status=(status&(~rx_data_status_codes::DATA_AVAILABLE))|
+          rx_data_status_codes::DATA_LOST;
+        statistics.overruns++;
+      }
+
+      statistics.frames_received++;
+      if(status&rx_data_status_codes::BAD_START_BIT) 
+        statistics.bad_start_bits++;
+      if(status&rx_data_status_codes::BAD_PARITY) 
+        statistics.bad_parities++;
+      if(status&rx_data_status_codes::BAD_STOP_BIT) 
+        statistics.bad_stop_bits++;
+
+      register uint32_t items=static_cast<uint32_t>(rx_buffer.items());
+      if(items>statistics.rx_high_water_mark) 
+        statistics.rx_high_water_mark=items;
+
+      return status;
+    }
+
+    // NOTE: the status of a frame read, in case of error, we put the 
+    // received raw data on the high 16 bits of status
+    template<typename FRAME_FORMAT>
+    inline uint32_t get_frame_status(
+      const FRAME_FORMAT& format,
+      frame_t frame
+    )
+    {
+      register uint32_t status=check_frame(
+        frame,
+        format.data_bits,
+        format.parity,
+        format.parity_bit_pos,
+        format.first_stop_bit_pos
+      );
+
+      if(
+        status&(
+          rx_data_status_codes::BAD_START_BIT|
+          rx_data_status_codes::BAD_PARITY|
+          rx_data_status_codes::BAD_STOP_BIT
+        )
+      ) status=status|(frame<<16);
+
+      return status;
+    }
+
+    // NOTE: the base of a context is a dependent type, so the names it
+    // takes from uart_core (typedef core) are brought in at once with
+    // this macro, the same for every port
+    #define SOFT_UART_USING_CORE_NAMES \
+      using core::get_rx_data; \
+      using core::get_rx_frame_status; \
+      using core::check_rx_frame; \
+      using core::data_available; \
+      using core::data_lost; \
+      using core::bad_status; \
+      using core::bad_start_bit; \
+      using core::bad_parity; \
+      using core::bad_stop_bit; \
+      using core::idle_line; \
+      using core::push_rx_idle_mark; \
+      using core::set_tx_data; \
+      using core::get_tx_frame; \
+      using core::push_rx_frame; \
+      using core::pop_tx_frame; \
+      using core::oversampling_interrupt; \
+      using core::oversampling_rx_edge; \
+      using core::start_oversampling_tx; \
+      using core::set_oversampling_bit_ticks; \
+      using core::reset_engine; \
+      using core::get_tx_status; \
+      using core::get_incoming_bit; \
+      using core::update_rx_data_buffer; \
+      using core::set_outgoing_bit; \
+      using core::format; \
+      using core::statistics; \
+      using core::rx_buffer; \
+      using core::tx_buffer; \
+      using core::rx_data; \
+      using core::rx_bit_counter; \
+      using core::rx_status; \
+      using core::rx_data_status; \
+      using core::rx_idle_bits; \
+      using core::rx_idle_quarters; \
+      using core::rx_idle_counter; \
+      using core::tx_data; \
+      using core::tx_bit_counter; \
+      using core::tx_status
+
+    // NOTE: the platform independent part of the uart contexts: the 
+    // frame format, the lock-free frame buffers, the validation of the
+    // frames received, the link statistics, and the OVERSAMPLING bit 
+    // engine, shared by the bit engines of every platform. PLATFORM is
+    // the context deriving from it (CRTP), it must provide start_tx() 
+    // (kicking off the transmission when idle), and its interrupt 
+    // handlers push the frames received with push_rx_frame() and pop 
+    // the frames to send with pop_tx_frame(). 
+    //
+    // The OVERSAMPLING engine (oversampling_interrupt() from a timer
+    // interrupting each quarter of bit, oversampling_rx_edge() from 
+    // the changes of the RX pin, and start_oversampling_tx()) is only
+    // instantiated if used, PLATFORM is then its pin, timer and lock
+    // policy, setting the ticks of a bit of its timer on config with
+    // set_oversampling_bit_ticks(), and providing:
+    //
+    //   start_timer(ticks): start the quarter of bit interrupts, the 
+    //     first one ticks later, restarting them if running (idle line 
+    //     detection)
+    //   set_timer_period(ticks): from the timer interrupt, the ticks to 
+    //     the next interrupt (the quarters alternate between the floor 
+    //     and the ceil of a quarter of bit)
+    //   stop_timer(): stop them
+    //   read_rx_pin(): the RX pin level (0 or 1)
+    //   write_tx_pin(level): set the TX pin level (0 or 1)
+    //   isr_guard: the lock taken by the interrupt handlers for the 
+    //     timer calls and the hooks
+    //   thread_guard: the lock taken by start_oversampling_tx(), from
+    //     the application
+    //
+    // and optionally the hooks called with the lock taken, when a frame
+    // is received (rx_frame_hook()), a frame is popped for sending 
+    // (tx_frame_hook()), the transmission ends (tx_end_hook()), and the
+    // line gets idle (rx_idle_hook())
+    template<
+      typename PLATFORM,
+      size_t RX_BUFFER_LENGTH,
+      size_t TX_BUFFER_LENGTH,
+      typename FRAME_FORMAT
+    > struct uart_core
+    {
+      uint32_t get_rx_data(uint32_t& data);
+
+      // NOTE: it returns the number of frames read (up to length), 
+      // without waiting, with their data on data (8 bits at most), and
+      // their status on statuses (if given)
+      size_t get_rx_data(
+        uint8_t* data,
+        size_t length,
+        uint32_t* statuses
+      );
+
+      // NOTE: the status of a frame read, with no side effects (the 
+      // frame was counted on the statistics when it was received)
+      uint32_t get_rx_frame_status(frame_t frame);
+
+      // NOTE: the errors of a frame (start bit, parity and stop bit)
+      uint32_t check_rx_frame(frame_t frame);
+  
+      int available() { return rx_buffer.items(); }
+  
+      bool data_available(uint32_t status)
+      { 
+        return (
+          status&(
+            rx_data_status_codes::DATA_AVAILABLE|
+            rx_data_status_codes::DATA_LOST
+          )
+        ); 
+      }
+  
+      bool data_lost(uint32_t status)
+      { return (status&rx_data_status_codes::DATA_LOST); }
+  
+      bool bad_status(uint32_t status)
+      {
+        return (
+          status&(
+            rx_data_status_codes::BAD_START_BIT|
+            rx_data_status_codes::BAD_PARITY|
+            rx_data_status_codes::BAD_STOP_BIT
+          )
+        );
+      }
+  
+      bool bad_start_bit(uint32_t status)
+      { return (status&rx_data_status_codes::BAD_START_BIT); }
+      
+      bool bad_parity(uint32_t status)
+      { return (status&rx_data_status_codes::BAD_PARITY); }
+      
+      bool bad_stop_bit(uint32_t status)
+      { return (status&rx_data_status_codes::BAD_STOP_BIT); }
+
+      bool idle_line(uint32_t status)
+      { return (status&rx_data_status_codes::IDLE_LINE); }
+  
+      // is TX buffer full?
+      bool is_tx_full() { return tx_buffer.is_full(); }
+  
+      int available_for_write() { return tx_buffer.available(); }
+  
+      // NOTE: only the 5, 6, 7, 8  or 9 lowest significant bits
+      // of data are send
+      bool set_tx_data(uint32_t data);
+
+      // NOTE: it returns the number of frames pushed, without 
+      // waiting for room on the TX buffer
+      size_t set_tx_data(const uint8_t* data,size_t length);
+
+      frame_t get_tx_frame(uint32_t data) { return format.encode(data); }
+  
+      void flush_rx() { rx_buffer.reset(); }
+
+      // NOTE: from the interrupt handlers, the frame is validated and
+      // counted on the statistics as it is received, it returns its 
+      // status (DATA_AVAILABLE, or DATA_LOST if it overwrote the oldest
+      // one, with the errors found)
+      uint32_t push_rx_frame(uint32_t frame)
+      {
+        return store_rx_frame(
+          format,rx_buffer,statistics,static_cast<frame_t>(frame)
+        );
+      }
+
+      bool pop_tx_frame(frame_t& frame)
+      {
+        if(!tx_buffer.pop(frame)) return false;
+
+        statistics.frames_sent++;
+        return true;
+      }
+
+      // NOTE: from the interrupt handlers, when the line has been idle
+      // for the timeout after a frame
+      void push_rx_idle_mark()
+      { if(!rx_buffer.push(RX_IDLE_MARK)) statistics.overruns++; }
+
+      void oversampling_interrupt();
+      void oversampling_rx_edge();
+      void start_oversampling_tx();
+
+      // NOTE: fixed point ticks of a bit of the timer of the 
+      // OVERSAMPLING engine, from the platform config
+      void set_oversampling_bit_ticks(uint32_t fixed_bit_ticks)
+      { oversampling_bit_ticks=fixed_bit_ticks; }
+
+      // NOTE: the quarters are rounded to the nearest from the start of
+      // the timer, so the fraction of tick starts at half a tick
+      void start_quarter_timer()
+      {
+        quarter_fraction=(1<<(TICK_FRACTION_BITS+1));
+        quarter_ticks=
+          advance_quarter_ticks(oversampling_bit_ticks,quarter_fraction);
+        platform()->start_timer(quarter_ticks);
+      }
+
+      void rx_frame_hook() {}
+      void tx_frame_hook() {}
+      void tx_end_hook() {}
+      void rx_idle_hook() {}
+
+      PLATFORM* platform() { return static_cast<PLATFORM*>(this); }
+
+      // NOTE: when configuring the uart, idle line detection is disabled
+      void reset_engine()
+      {
+        rx_status=rx_status_codes::LISTENING;
+        rx_data_status=rx_data_status_codes::NO_DATA_AVAILABLE;
+        rx_buffer.reset();
+        rx_interrupt_counter=0;
+        rx_idle_bits=rx_idle_quarters=rx_idle_counter=0;
+
+        tx_status=tx_status_codes::IDLE;
+        tx_buffer.reset();
+        tx_interrupt_counter=0;
+
+        statistics.reset();
+      }
+
+      tx_status_codes get_tx_status() { return tx_status; }
+
+      void get_incoming_bit()
+      { rx_data |= (rx_bit<<rx_bit_counter); }
+
+      void update_rx_data_buffer()
+      { rx_data_status=push_rx_frame(rx_data); }
+
+      void set_outgoing_bit()
+      { platform()->write_tx_pin((tx_data>>tx_bit_counter) & 1); }
+
+      // serial protocol
+      FRAME_FORMAT format;
+
+      link_statistics statistics;
+
+      // NOTE: the buffers are lock-free, the interrupt handlers are 
+      // the producer of rx_buffer and the consumer of tx_buffer, and 
+      // the application the other side
+      circular_spsc_fifo<frame_t,RX_BUFFER_LENGTH> rx_buffer;
+      spsc_fifo<frame_t,TX_BUFFER_LENGTH> tx_buffer;
+
+      // rx data
+      volatile uint32_t rx_data;
+      volatile uint32_t rx_bit_counter;
+      volatile uint32_t rx_bit;
+      volatile rx_status_codes rx_status;
+      volatile uint32_t rx_data_status;
+      volatile uint32_t rx_interrupt_counter;
+
+      // idle line detection (disabled with zero bits)
+      uint32_t rx_idle_bits;
+      uint32_t rx_idle_quarters;
+      volatile uint32_t rx_idle_counter; // quarters left
+
+      // tx data
+      volatile uint32_t tx_data;
+      volatile uint32_t tx_bit_counter;
+      volatile tx_status_codes tx_status;
+      volatile uint32_t tx_interrupt_counter;
+
+      // quarters of bit of the OVERSAMPLING engine
+      uint32_t oversampling_bit_ticks;
+      uint32_t quarter_fraction;
+      uint32_t quarter_ticks;
+    };
+
+    template<
+      typename PLATFORM,
+      size_t RX_BUFFER_LENGTH,
+      size_t TX_BUFFER_LENGTH,
+      typename FRAME_FORMAT
+    > uint32_t uart_core<
+      PLATFORM,
+      RX_BUFFER_LENGTH,
+      TX_BUFFER_LENGTH,
+      FRAME_FORMAT
+    >::get_rx_data(
+      uint32_t& data
+    )
+    {
+      frame_t data_received;
+      
+      if(!rx_buffer.pop(data_received)) 
+        return rx_data_status_codes::NO_DATA_AVAILABLE;
+
+      data=(data_received>>1)&format.data_mask;
+  
+      return get_rx_frame_status(data_received);
+    }
+
+    template<
+      typename PLATFORM,
+      size_t RX_BUFFER_LENGTH,
+      size_t TX_BUFFER_LENGTH,
+      typename FRAME_FORMAT
+    > size_t uart_core<
+      PLATFORM,
+      RX_BUFFER_LENGTH,
+      TX_BUFFER_LENGTH,
+      FRAME_FORMAT
+    >::get_rx_data(
+      uint8_t* data,
+      size_t length,
+      uint32_t* statuses
+    )
+    {
+      // NOTE: frames are popped in chunks, and then validated
+      frame_t frames[RX_CHUNK_FRAMES];
+      size_t count=0;
+
+      while(count<length)
+      {
+        size_t chunk=length-count;
+        if(chunk>RX_CHUNK_FRAMES) chunk=RX_CHUNK_FRAMES;
+
+        size_t popped=rx_buffer.pop(frames,chunk);
+        if(!popped) break;
+
+        for(size_t i=0; i<popped; i++)
+        {
+          // NOTE: the idle line marks are only read with statuses
+          if(!statuses && (frames[i]==RX_IDLE_MARK)) continue;
+
+          data[count]=
+            static_cast<uint8_t>((frames[i]>>1)&format.data_mask);
+
+          uint32_t status=get_rx_frame_status(frames[i]);
+          if(statuses) statuses[count]=status;
+          count++;
+        }
+      }
+
+      return count;
+    }
+
+    template<
+      typename PLATFORM,
+      size_t RX_BUFFER_LENGTH,
+      size_t TX_BUFFER_LENGTH,
+      typename FRAME_FORMAT
+    > uint32_t uart_core<
+      PLATFORM,
+      RX_BUFFER_LENGTH,
+      TX_BUFFER_LENGTH,
+      FRAME_FORMAT
+    >::check_rx_frame(
+      frame_t frame
+    )
+    {
+      return check_frame(
+        frame,
+        format.data_bits,
+        format.parity,
+        format.parity_bit_pos,
+        format.first_stop_bit_pos
+      );
+    }
+
+    template<
+      typename PLATFORM,
+      size_t RX_BUFFER_LENGTH,
+      size_t TX_BUFFER_LENGTH,
+      typename FRAME_FORMAT
+    > uint32_t uart_core<
+      PLATFORM,
+      RX_BUFFER_LENGTH,
+      TX_BUFFER_LENGTH,
+      FRAME_FORMAT
+    >::get_rx_frame_status(
+      frame_t frame
+    )
+    {
+      if(frame==RX_IDLE_MARK) return rx_data_status_codes::IDLE_LINE;
+
+      return get_frame_status(format,frame);
+    }
+
+    template<
+      typename PLATFORM,
+      size_t RX_BUFFER_LENGTH,
+      size_t TX_BUFFER_LENGTH,
+      typename FRAME_FORMAT
+    > bool uart_core<
+      PLATFORM,
+      RX_BUFFER_LENGTH,
+      TX_BUFFER_LENGTH,
+      FRAME_FORMAT
+    >::set_tx_data(
+      uint32_t data
+    )
+    {
+      // tx buffer full
+      if(!tx_buffer.push(get_tx_frame(data))) 
+      { statistics.tx_full_rejections++; return false; }
+
+      static_cast<PLATFORM*>(this)->start_tx();
+
+      return true;
+    }
+
+    template<
+      typename PLATFORM,
+      size_t RX_BUFFER_LENGTH,
+      size_t TX_BUFFER_LENGTH,
+      typename FRAME_FORMAT
+    > size_t uart_core<
+      PLATFORM,
+      RX_BUFFER_LENGTH,
+      TX_BUFFER_LENGTH,
+      FRAME_FORMAT
+    >::set_tx_data(
+      const uint8_t* data,
+      size_t length
+    )
+    {
+      // NOTE: the frames that do not fit are rejected at once, the 
+      // rest are framed and pushed in a row, and the transmission is 
+      // kicked off just once
+      size_t free_frames=static_cast<size_t>(tx_buffer.available());
+      if(length>free_frames) 
+      { 
+        statistics.tx_full_rejections+=length-free_frames; 
+        length=free_frames; 
+      }
+
+      for(size_t i=0; i<length; i++) 
+        tx_buffer.push(get_tx_frame(data[i]));
+
+      if(length) static_cast<PLATFORM*>(this)->start_tx();
+
+      return length;
+    }
+
+    template<
+      typename PLATFORM,
+      size_t RX_BUFFER_LENGTH,
+      size_t TX_BUFFER_LENGTH,
+      typename FRAME_FORMAT
+    > void uart_core<
+      PLATFORM,
+      RX_BUFFER_LENGTH,
+      TX_BUFFER_LENGTH,
+      FRAME_FORMAT
+    >::oversampling_interrupt()
+    {
+      // NOTE: the timer is already on the quarter begun with this 
+      // interrupt, so its period is set right away
+      {
+        register uint32_t ticks=
+          advance_quarter_ticks(oversampling_bit_ticks,quarter_fraction);
+        if(ticks!=quarter_ticks)
+        {
+          quarter_ticks=ticks;
+
+          typename PLATFORM::isr_guard guard;
+          platform()->set_timer_period(ticks);
+        }
+      }
+
+      // idle line code
+      if(rx_idle_counter && (rx_status==rx_status_codes::LISTENING))
+      {
+        rx_idle_counter=rx_idle_counter-1;
+        if(!rx_idle_counter)
+        {
+          push_rx_idle_mark();
+
+          typename PLATFORM::isr_guard guard;
+          if(tx_status==tx_status_codes::IDLE) platform()->stop_timer();
+          platform()->rx_idle_hook();
+        }
+      }
+
+      // rx code
+      if(rx_status==rx_status_codes::RECEIVING)
+      {
+        if(rx_interrupt_counter==1)
+        {
+          get_incoming_bit(); 
+          rx_bit_counter++;
+          if(rx_bit_counter==format.rx_frame_bits)
+          {
+            if(format.stop_bits==stop_bit_codes::TWO_STOP_BITS)
+              get_incoming_bit();
+
+            // NOTE: with idle line detection the timer keeps on 
+            // interrupting up to the idle line timeout
+            rx_idle_counter=rx_idle_quarters;
+            update_rx_data_buffer();
+
+            {
+              typename PLATFORM::isr_guard guard;
+              if((tx_status==tx_status_codes::IDLE) && !rx_idle_counter) 
+                platform()->stop_timer();
+              platform()->rx_frame_hook();
+            }
+  
+            rx_status=rx_status_codes::LISTENING;
+          }
+        }
+        rx_interrupt_counter=(rx_interrupt_counter+1)&0x3;
+      }
+  
+      // tx code
+      if(tx_status==tx_status_codes::SENDING)
+      {
+        if(tx_interrupt_counter==0)
+        {
+          if(tx_bit_counter>=format.tx_frame_bits)
+          {
+            frame_t data_to_send;
+            if(pop_tx_frame(data_to_send)) 
+            { 
+              tx_data=data_to_send; tx_bit_counter=0; 
+              set_outgoing_bit(); tx_bit_counter++;
+
+              typename PLATFORM::isr_guard guard;
+              platform()->tx_frame_hook();
+            }
+            else
+            {
+              typename PLATFORM::isr_guard guard;
+              if(
+                (rx_status==rx_status_codes::LISTENING) && 
+                !rx_idle_counter
+              ) platform()->stop_timer();
+  
+              tx_status=tx_status_codes::IDLE;
+              platform()->tx_end_hook();
+            }
+          }
+          else { set_outgoing_bit(); tx_bit_counter++; }
+        }
+        tx_interrupt_counter=(tx_interrupt_counter+1)&0x3;
+      }
+    }
+
+    template<
+      typename PLATFORM,
+      size_t RX_BUFFER_LENGTH,
+      size_t TX_BUFFER_LENGTH,
+      typename FRAME_FORMAT
+    > void uart_core<
+      PLATFORM,
+      RX_BUFFER_LENGTH,
+      TX_BUFFER_LENGTH,
+      FRAME_FORMAT
+    >::oversampling_rx_edge()
+    {
+      register uint32_t sampled_bit=platform()->read_rx_pin();
+  
+      switch(rx_status)
+      {
+        case rx_status_codes::LISTENING:
+          if(!sampled_bit)
+          {
+            rx_status=rx_status_codes::RECEIVING;
+            rx_data=rx_bit_counter=rx_bit=0;
+            rx_interrupt_counter=0;
+            
+            // NOTE: the timer may be running for idle line detection, 
+            // it is restarted on the start bit
+            if(tx_status==tx_status_codes::IDLE) 
+            { 
+              typename PLATFORM::isr_guard guard;
+              start_quarter_timer(); 
+              rx_interrupt_counter=1; 
+            }
+            rx_idle_counter=0;
+          } 
+          break;
+          
+        case rx_status_codes::RECEIVING:
+          rx_bit=sampled_bit;
+          break;
+      }
+    }
+
+    template<
+      typename PLATFORM,
+      size_t RX_BUFFER_LENGTH,
+      size_t TX_BUFFER_LENGTH,
+      typename FRAME_FORMAT
+    > void uart_core<
+      PLATFORM,
+      RX_BUFFER_LENGTH,
+      TX_BUFFER_LENGTH,
+      FRAME_FORMAT
+    >::start_oversampling_tx()
+    {
+      // NOTE: the transmission is only kicked off when idle, 
+      // otherwise the interrupt handler pops the data just pushed
+      if(tx_status!=tx_status_codes::IDLE) return;
+
+      typename PLATFORM::thread_guard guard;
+
+      // NOTE: the interrupt handler may have sent the data just pushed
+      // (going idle again) before taking the lock, so the status is 
+      // checked again, and nothing is sent if the TX buffer is empty
+      if(tx_status!=tx_status_codes::IDLE) return;
+
+      frame_t frame_to_send;
+      if(!pop_tx_frame(frame_to_send)) return;
+
+      tx_data=frame_to_send; tx_bit_counter=0; 
+      tx_interrupt_counter=0;
+
+      // NOTE: the timer may be running for idle line detection
+      if((rx_status==rx_status_codes::LISTENING) && !rx_idle_counter) 
+        start_quarter_timer();
+
+      tx_status=tx_status_codes::SENDING;
+      platform()->tx_frame_hook();
+    }
       
 
   } // namespace soft_uart
     
   #ifndef CHIBIOS_PORT
   
-    #include "Arduino.h"
+    #ifdef SOFT_UART_HOST_PORT
+      // simulated peripherals for running on the host 
+      #include "host_port.h"
+    #else
+      #include "Arduino.h"
+    #endif
     
     #include <type_traits>
     
-    #define serial_tc_declaration(id,rx_length,tx_length) \
+    #define serial_tc_format_declaration(id,rx_length,tx_length,format) \
     void TC##id##_Handler(void) \
     { \
       uint32_t status=TC_GetStatus( \
@@ -138,18 +1322,28 @@
       soft_uart::arduino_due::uart< \
         soft_uart::arduino_due::timer_ids::TIMER_TC##id, \
         rx_length, \
-        tx_length \
+        tx_length, \
+        format \
       >::tc_interrupt(status); \
     } \
     \
     typedef soft_uart::arduino_due::serial< \
       soft_uart::arduino_due::timer_ids::TIMER_TC##id, \
       rx_length, \
-      tx_length \
+      tx_length, \
+      format \
     > serial_tc##id##_t; \
     \
     serial_tc##id##_t serial_tc##id;
     
+    #define serial_tc_declaration(id,rx_length,tx_length) \
+    serial_tc_format_declaration( \
+      id, \
+      rx_length, \
+      tx_length, \
+      soft_uart::runtime_frame_format \
+    )
+    
     #define serial_tc0_declaration(rx_length,tx_length) \
     serial_tc_declaration(0,rx_length,tx_length)
     
@@ -222,6 +1416,21 @@
           Tc* tc_p; 
           uint32_t channel;
           IRQn_Type irq;
+
+          // NOTE: reset on RC compare the counter goes from 0 to RC, so
+          // the period is RC+1 ticks. From the RC compare interrupt, the
+          // period just begun is changed, unless the counter has already
+          // gone past the new RC (the compare would not happen until the
+          // counter wraps around), then the current period is kept
+          void set_rc_period(uint32_t ticks)
+          {
+            register uint32_t counter=tc_p->TC_CHANNEL[channel].TC_CV;
+            if(
+              (counter<ticks-1) || 
+              // the counter still on RC is being reset
+              (counter==tc_p->TC_CHANNEL[channel].TC_RC)
+            ) tc_p->TC_CHANNEL[channel].TC_RC=ticks-1;
+          }
         };
       
         class interrupt_guard
@@ -231,6 +1440,60 @@
             interrupt_guard() { __disable_irq(); }
             ~interrupt_guard() { __enable_irq(); }
         };
+
+        // NOTE: the interrupt handlers of the uarts (TC and PIO) have 
+        // the same priority, so they do not preempt each other
+        class null_guard
+        {
+          public:
+      
+            null_guard() {}
+            ~null_guard() {}
+        };
+
+        // NOTE: called on each iteration of the busy waits, on the 
+        // host port it lets the simulated time go by
+        inline void busy_wait() 
+        {
+          #ifdef SOFT_UART_HOST_PORT
+            host::busy_wait();
+          #endif
+        }
+
+        #ifdef SOFT_UART_ISR_PROFILING
+
+          // NOTE: a cycle source is a class with static functions 
+          // enable() and get_cycles(), by default the cycle counter of
+          // the Cortex-M3 DWT unit (or the host clock on the host port),
+          // another one can be plugged defining macro 
+          // SOFT_UART_CYCLE_SOURCE before including this file
+          #ifdef SOFT_UART_HOST_PORT
+
+            #ifndef SOFT_UART_CYCLE_SOURCE
+              #define SOFT_UART_CYCLE_SOURCE soft_uart::host::cycle_source
+            #endif
+
+          #else
+
+            struct dwt_cycle_source
+            {
+              static void enable()
+              {
+                CoreDebug->DEMCR|=CoreDebug_DEMCR_TRCENA_Msk;
+                DWT->CTRL|=DWT_CTRL_CYCCNTENA_Msk;
+              }
+
+              static uint32_t get_cycles() { return DWT->CYCCNT; }
+            };
+
+            #ifndef SOFT_UART_CYCLE_SOURCE
+              #define SOFT_UART_CYCLE_SOURCE \
+                soft_uart::arduino_due::dwt_cycle_source
+            #endif
+
+          #endif
+
+        #endif // SOFT_UART_ISR_PROFILING
       
         extern tc_timer_data 
           tc_timer_table[static_cast<uint32_t>(timer_ids::TIMER_IDS)];
@@ -238,7 +1501,8 @@
         template<
           timer_ids TIMER,
           size_t RX_BUFFER_LENGTH,
-          size_t TX_BUFFER_LENGTH
+          size_t TX_BUFFER_LENGTH,
+          typename FRAME_FORMAT = runtime_frame_format
         > class uart 
         {
           static_assert(TIMER<timer_ids::TIMER_IDS,"[ERROR] Bad TC id provided to instantiate template uart");
@@ -260,7 +1524,9 @@
               uint32_t bit_rate = bit_rates::DEFAULT_BIT_RATE,
               data_bit_codes the_data_bits = data_bit_codes::EIGHT_BITS,
               parity_codes the_parity = parity_codes::EVEN_PARITY,
-              stop_bit_codes the_stop_bits = stop_bit_codes::ONE_STOP_BIT
+              stop_bit_codes the_stop_bits = stop_bit_codes::ONE_STOP_BIT,
+              rx_decoder_codes the_rx_decoder = rx_decoder_codes::OVERSAMPLING,
+              tx_encoder_codes the_tx_encoder = tx_encoder_codes::PER_BIT
             ) 
             {
               _mode_=mode_codes::INVALID_MODE;
@@ -278,18 +1544,18 @@
                   bit_rate,
                   the_data_bits,
                   the_parity,
-                  the_stop_bits
+                  the_stop_bits,
+                  the_rx_decoder,
+                  the_tx_encoder
                 ); 
       
               if(ret_code!=return_codes::EVERYTHING_OK) return ret_code;
                       
               // cofigure tx pin
-              pinMode(tx_pin,OUTPUT);
-              digitalWrite(tx_pin,HIGH);
+              _ctx_.config_tx_pin();
       
               // configure & attatch interrupt on rx pin
-              pinMode(rx_pin,INPUT_PULLUP);
-              attachInterrupt(rx_pin,uart::rx_interrupt,CHANGE);
+              _ctx_.attach_rx_interrupt();
       
               _mode_=mode_codes::FULL_DUPLEX;
       
@@ -302,7 +1568,9 @@
               data_bit_codes the_data_bits = data_bit_codes::EIGHT_BITS,
               parity_codes the_parity = parity_codes::EVEN_PARITY,
               stop_bit_codes the_stop_bits = stop_bit_codes::ONE_STOP_BIT,
-              bool in_rx_mode = true
+              bool in_rx_mode = true,
+              rx_decoder_codes the_rx_decoder = rx_decoder_codes::OVERSAMPLING,
+              tx_encoder_codes the_tx_encoder = tx_encoder_codes::PER_BIT
             ) 
             {
               _mode_=mode_codes::INVALID_MODE;
@@ -317,7 +1585,9 @@
                   bit_rate,
                   the_data_bits,
                   the_parity,
-                  the_stop_bits
+                  the_stop_bits,
+                  the_rx_decoder,
+                  the_tx_encoder
                 ); 
       
               if(ret_code!=return_codes::EVERYTHING_OK) return ret_code;
@@ -325,15 +1595,13 @@
               if(in_rx_mode)
               {
                 // configure & attatch interrupt on rx pin
-                pinMode(rx_tx_pin,INPUT_PULLUP);
-                attachInterrupt(rx_tx_pin,uart::rx_interrupt,CHANGE);
+                _ctx_.attach_rx_interrupt();
                 _mode_=mode_codes::RX_MODE;
               }
               else
               {
                 // cofigure tx pin
-                pinMode(rx_tx_pin,OUTPUT);
-                digitalWrite(rx_tx_pin,HIGH);
+                _ctx_.config_tx_pin();
                 _mode_=mode_codes::TX_MODE;
               }
       
@@ -352,8 +1620,7 @@
               if(_mode_==mode_codes::RX_MODE) return true; 
               flush();
       
-              pinMode(_ctx_.rx_pin,INPUT_PULLUP);
-              attachInterrupt(_ctx_.rx_pin,uart::rx_interrupt,CHANGE);
+              _ctx_.attach_rx_interrupt();
               
               _mode_=mode_codes::RX_MODE;
               return true;
@@ -369,11 +1636,10 @@
               if(_mode_==mode_codes::TX_MODE) return true;
       
               // waiting to finish reception
-              while(_ctx_.rx_status==rx_status_codes::RECEIVING) { /* do nothing */ } 
+              while(_ctx_.rx_status==rx_status_codes::RECEIVING) { busy_wait(); } 
       
-              detachInterrupt(_ctx_.rx_pin);
-              pinMode(_ctx_.tx_pin,OUTPUT);
-              digitalWrite(_ctx_.tx_pin,HIGH);
+              _ctx_.detach_rx_interrupt();
+              _ctx_.config_tx_pin();
       
               _mode_=mode_codes::TX_MODE;
               return true;
@@ -383,10 +1649,48 @@
       
             int available() { return _ctx_.available(); }
       
-            static void tc_interrupt(uint32_t the_status)
-            { _ctx_.tc_interrupt(the_status); }
-      
-            static void rx_interrupt() { _ctx_.rx_interrupt(); }
+            #ifdef SOFT_UART_ISR_PROFILING
+
+              static void tc_interrupt(uint32_t the_status)
+              { 
+                uint32_t start=SOFT_UART_CYCLE_SOURCE::get_cycles();
+                _ctx_.tc_interrupt(the_status); 
+                _ctx_.tc_profile.add(
+                  SOFT_UART_CYCLE_SOURCE::get_cycles()-start
+                );
+              }
+        
+              static void rx_interrupt() 
+              { 
+                uint32_t start=SOFT_UART_CYCLE_SOURCE::get_cycles();
+                _ctx_.rx_interrupt(); 
+                _ctx_.rx_profile.add(
+                  SOFT_UART_CYCLE_SOURCE::get_cycles()-start
+                );
+              }
+
+              // NOTE: copies taken with interrupts disabled, profiles
+              // are reset when configuring the uart
+              isr_profile get_tc_isr_profile() 
+              { interrupt_guard guard; return _ctx_.tc_profile; }
+
+              isr_profile get_rx_isr_profile() 
+              { interrupt_guard guard; return _ctx_.rx_profile; }
+
+              void reset_isr_profiles()
+              { 
+                interrupt_guard guard; 
+                _ctx_.tc_profile.reset(); _ctx_.rx_profile.reset(); 
+              }
+
+            #else
+
+              static void tc_interrupt(uint32_t the_status)
+              { _ctx_.tc_interrupt(the_status); }
+        
+              static void rx_interrupt() { _ctx_.rx_interrupt(); }
+
+            #endif // SOFT_UART_ISR_PROFILING
       
             timer_ids get_timer() { return TIMER; }
       
@@ -394,8 +1698,13 @@
             size_t get_tx_buffer_length() { return TX_BUFFER_LENGTH; }
         
             uint32_t get_bit_rate() { return _ctx_.bit_rate; }
-            double get_bit_time() { return _ctx_.bit_time; }	
-            double get_frame_time() { return _ctx_.frame_time; }	
+            double get_bit_time() 
+            { return double(1)/double(_ctx_.bit_rate); }	
+            double get_frame_time() 
+            { return double(_ctx_.format.tx_frame_bits)/double(_ctx_.bit_rate); }	
+
+            rx_decoder_codes get_rx_decoder() { return _ctx_.rx_decoder; }
+            tx_encoder_codes get_tx_encoder() { return _ctx_.tx_encoder; }
       
             uint32_t get_rx_data(uint32_t& data) 
             { 
@@ -410,6 +1719,47 @@
                   )
               );
             }
+
+            // NOTE: it returns the number of frames read (up to length)
+            // without waiting, with their data on data (8 bits at most), 
+            // and their status on statuses (if not null)
+            size_t get_rx_data(
+              uint8_t* data,
+              size_t length,
+              uint32_t* statuses = nullptr
+            ) 
+            { 
+              return (
+                (
+                  (_mode_==mode_codes::FULL_DUPLEX) ||
+                  (_mode_==mode_codes::RX_MODE)
+                )? _ctx_.get_rx_data(data,length,statuses): 0
+              );
+            }
+
+            // NOTE: zero-copy reception, it gives the largest run of 
+            // frames received which can be read in place in the 
+            // reception buffer (up to its end), with their data and 
+            // status given by get_frame_data() and get_frame_status(),
+            // consume() pops the first n of them, returning false if 
+            // some could have been overwritten while being read
+            size_t peek_contiguous(const frame_t*& frames)
+            {
+              if(
+                (_mode_!=mode_codes::FULL_DUPLEX) &&
+                (_mode_!=mode_codes::RX_MODE)
+              ) { frames=nullptr; return 0; }
+
+              return _ctx_.rx_buffer.peek_contiguous(frames);
+            }
+
+            bool consume(size_t n) { return _ctx_.rx_buffer.consume(n); }
+
+            uint32_t get_frame_data(frame_t frame)
+            { return (frame>>1)&_ctx_.format.data_mask; }
+
+            uint32_t get_frame_status(frame_t frame)
+            { return _ctx_.get_rx_frame_status(frame); }
       
             bool data_available(uint32_t status)
             { return _ctx_.data_available(status); }
@@ -428,6 +1778,20 @@
       
             bool bad_stop_bit(uint32_t status) 
             { return _ctx_.bad_stop_bit(status); }
+
+            bool idle_line(uint32_t status) 
+            { return _ctx_.idle_line(status); }
+
+            // NOTE: idle line detection, when the line stays idle for 
+            // bits bit times after a frame (counted from the middle of
+            // its stop bit), a mark is put on the RX buffer, which is 
+            // read as status IDLE_LINE, delimiting packets (e.g., 3.5 
+            // characters on Modbus RTU), zero bits disable it (as 
+            // after configuring the object)
+            void set_rx_idle_timeout(uint32_t bits) 
+            { _ctx_.set_rx_idle_timeout(bits); }
+
+            uint32_t get_rx_idle_timeout() { return _ctx_.rx_idle_bits; }
       
             // is TX buffer full?
             bool is_tx_full() 
@@ -461,8 +1825,27 @@
                 )? _ctx_.set_tx_data(data): false
               ); 
             }
+
+            // NOTE: data is 8 bits length, it returns the number of 
+            // frames pushed without waiting for room on the TX buffer
+            size_t set_tx_data(const uint8_t* data,size_t length) 
+            { 
+              return (
+                (
+                  (_mode_==mode_codes::FULL_DUPLEX) ||
+                  (_mode_==mode_codes::TX_MODE)
+                )? _ctx_.set_tx_data(data,length): 0
+              ); 
+            }
       
             tx_status_codes get_tx_status() { return _ctx_.get_tx_status(); }
+
+            // NOTE: a copy taken with interrupts disabled
+            link_statistics get_link_statistics()
+            { interrupt_guard guard; return _ctx_.statistics; }
+
+            void reset_link_statistics()
+            { interrupt_guard guard; _ctx_.statistics.reset(); }
       
             void flush() { _ctx_.flush(); }
       
@@ -470,8 +1853,61 @@
       
           private:
       
-            struct _uart_ctx_
+            // NOTE: the longest valid frame (start bit, 9 data bits,
+            // parity and stop bit) has 12 edges at most, the rest
+            // is margin for glitches
+            static constexpr uint32_t MAX_RX_EDGES=16;
+
+            // NOTE: the minimum time ahead of the counter an RA compare
+            // must be programmed to be sure it is not missed
+            static constexpr uint32_t MIN_WAVEFORM_LEAD_TICKS=16;
+
+            // NOTE: the bit engine of the SAM3X TCs on the uart core
+            struct _uart_ctx_: uart_core<
+              _uart_ctx_,
+              RX_BUFFER_LENGTH,
+              TX_BUFFER_LENGTH,
+              FRAME_FORMAT
+            >
             {
+              typedef uart_core<
+                _uart_ctx_,
+                RX_BUFFER_LENGTH,
+                TX_BUFFER_LENGTH,
+                FRAME_FORMAT
+              > core;
+
+              SOFT_UART_USING_CORE_NAMES;
+
+              // the policy of the OVERSAMPLING engine of the core
+              typedef null_guard isr_guard;
+              typedef interrupt_guard thread_guard;
+
+              // NOTE: when restarted for a start bit, the timer may be 
+              // running for idle line detection, and an RC compare of it 
+              // latched but not served yet is discarded, otherwise the
+              // first quarter would be served right away
+              void start_timer(uint32_t ticks)
+              {
+                TC_SetRC(timer_p->tc_p,timer_p->channel,ticks-1);
+                start_tc_interrupts();
+                TC_GetStatus(timer_p->tc_p,timer_p->channel);
+                NVIC_ClearPendingIRQ(timer_p->irq);
+              }
+
+              void set_timer_period(uint32_t ticks)
+              { timer_p->set_rc_period(ticks); }
+
+              void stop_timer() { stop_tc_interrupts(); }
+
+              uint32_t read_rx_pin()
+              { return (PIO_Get(rx_pio_p,PIO_INPUT,rx_mask))? 1: 0; }
+
+              void write_tx_pin(uint32_t level)
+              {
+                if(level) PIO_Set(tx_pio_p,tx_mask);
+                else PIO_Clear(tx_pio_p,tx_mask);
+              }
       
               return_codes config(
                 uint32_t the_rx_pin,
@@ -479,7 +1915,9 @@
                 uint32_t the_bit_rate,
                 data_bit_codes the_data_bits,
                 parity_codes the_parity,
-                stop_bit_codes the_stop_bits
+                stop_bit_codes the_stop_bits,
+                rx_decoder_codes the_rx_decoder,
+                tx_encoder_codes the_tx_encoder
               );
       
               void end()
@@ -488,93 +1926,67 @@
       
                 disable_tc_interrupts(); disable_rx_interrupts();
       
-                stop_tc_interrupts(); detachInterrupt(rx_pin);
+                stop_tc_interrupts(); detach_rx_interrupt();
       
                 pmc_disable_periph_clk(uint32_t(timer_p->irq));
               }
       
               void tc_interrupt(uint32_t the_status);
               void rx_interrupt();
-      
-              uint32_t get_rx_data(uint32_t& data);
-      
-              int available()
+
+              void attach_rx_interrupt()
               {
-                interrupt_guard guard;
-                return rx_buffer.items();
-              }
-      
-              bool data_available(uint32_t status)
-              { 
-                return (
-                  status&(
-                    rx_data_status_codes::DATA_AVAILABLE|
-                    rx_data_status_codes::DATA_LOST
-                  )
-                ); 
+                if(rx_decoder==rx_decoder_codes::INPUT_CAPTURE)
+                {
+                  // the pin is handed over to the TC channel (TIOA)
+                  PIO_Configure(
+                    rx_pio_p,
+                    g_APinDescription[rx_pin].ulPinType,
+                    rx_mask,
+                    g_APinDescription[rx_pin].ulPinConfiguration|PIO_PULLUP
+                  );
+                  rx_last_level=1;
+                  enable_tc_capture_interrupts();
+                }
+                else
+                {
+                  pinMode(rx_pin,INPUT_PULLUP);
+                  attachInterrupt(rx_pin,uart::rx_interrupt,CHANGE);
+                }
               }
-      
-              bool data_lost(uint32_t status)
-              { return (status&rx_data_status_codes::DATA_LOST); }
-      
-              bool bad_status(uint32_t status)
+
+              void detach_rx_interrupt()
               {
-                return (
-                  status&(
-                    rx_data_status_codes::BAD_START_BIT|
-                    rx_data_status_codes::BAD_PARITY|
-                    rx_data_status_codes::BAD_STOP_BIT
-                  )
-                );
-              }
-      
-              bool bad_start_bit(uint32_t status)
-              { return (status&rx_data_status_codes::BAD_START_BIT); }
-              
-              bool bad_parity(uint32_t status)
-              { return (status&rx_data_status_codes::BAD_PARITY); }
-              
-              bool bad_stop_bit(uint32_t status)
-              { return (status&rx_data_status_codes::BAD_STOP_BIT); }
-      
-              // is TX buffer full?
-              bool is_tx_full() 
-              { 
-                interrupt_guard guard;
-                return tx_buffer.is_full();
+                if(rx_decoder==rx_decoder_codes::INPUT_CAPTURE)
+                  disable_tc_capture_interrupts();
+                else detachInterrupt(rx_pin);
               }
-      
-              int available_for_write() 
-              { 
-                interrupt_guard guard;
-                return tx_buffer.available();
+
+              void config_tx_pin()
+              {
+                if(tx_encoder==tx_encoder_codes::WAVEFORM)
+                  // the pin is handed over to the TC channel (TIOA),
+                  // its level was set high by the TC configuration
+                  PIO_Configure(
+                    tx_pio_p,
+                    g_APinDescription[tx_pin].ulPinType,
+                    tx_mask,
+                    g_APinDescription[tx_pin].ulPinConfiguration
+                  );
+                else
+                {
+                  pinMode(tx_pin,OUTPUT);
+                  digitalWrite(tx_pin,HIGH);
+                }
               }
       
-              // NOTE: only the 5, 6, 7, 8  or 9 lowest significant bits
-              // of data are send
-              bool set_tx_data(uint32_t data);
+              void start_tx();
       
               void flush()
               {
                 // wait until sending everything
                 while(tx_status!=tx_status_codes::IDLE) 
-                { /*nothing */ }
-              }
-      
-              void flush_rx()
-              {
-                interrupt_guard guard;
-                rx_buffer.reset();
-              }
-      
-              tx_status_codes get_tx_status() { return tx_status; }
-      
-              uint32_t get_even_parity(uint32_t data,uint32_t bits)
-              {
-                uint32_t odd_parity=data&1;
-                for(uint32_t bit=1; bit<bits; bit++)
-                  odd_parity=odd_parity^((data>>bit)&1);
-                return odd_parity;
+                { busy_wait(); }
               }
       
               void config_rx_interrupt() 
@@ -648,23 +2060,75 @@
                   TC_IDR_CPCS;
               }
       
-              void get_incoming_bit()
-              { rx_data |= (rx_bit<<rx_bit_counter); }
-      
-              void update_rx_data_buffer()
+              void enable_tc_capture_interrupts()
+              {
+                timer_p->tc_p->TC_CHANNEL[timer_p->channel].TC_IER=
+                  TC_IER_LDRAS|TC_IER_LDRBS;
+              }
+
+              void disable_tc_capture_interrupts()
+              {
+                timer_p->tc_p->TC_CHANNEL[timer_p->channel].TC_IDR=
+                  TC_IDR_LDRAS|TC_IDR_LDRBS;
+              }
+
+              uint32_t get_tc_counter()
+              { return timer_p->tc_p->TC_CHANNEL[timer_p->channel].TC_CV; }
+
+              uint32_t get_tc_ra()
+              { return timer_p->tc_p->TC_CHANNEL[timer_p->channel].TC_RA; }
+
+              uint32_t get_tc_rb()
+              { return timer_p->tc_p->TC_CHANNEL[timer_p->channel].TC_RB; }
+
+              // NOTE: deadlines are absolute values of the free-running
+              // TC counter, so they are compared through their (signed)
+              // difference to survive counter wrap-arounds
+              static bool is_due(uint32_t deadline,uint32_t now)
+              { return (static_cast<int32_t>(now-deadline)>=0); }
+
+              bool schedule_next_deadline();
+              void deadline_interrupt();
+              void waveform_interrupt();
+              void schedule_waveform_edge(uint32_t level);
+              void capture_interrupt(uint32_t the_status);
+              void rx_edge(uint32_t now,uint32_t level);
+              void decode_rx_edges();
+      
+              void set_rx_idle_timeout(uint32_t bits)
               {
-                rx_data_status=(
-                  (rx_buffer.push(static_cast<uint32_t>(rx_data)))?
-                    rx_data_status_codes::DATA_AVAILABLE:
-                    rx_data_status_codes::DATA_LOST
+                interrupt_guard guard;
+
+                rx_idle_bits=bits; rx_idle_quarters=(bits<<2);
+                rx_idle_ticks=static_cast<uint32_t>(
+                  (static_cast<uint64_t>(bits)*fixed_bit_ticks)>>
+                    TICK_FRACTION_BITS
                 );
+                rx_idle_counter=0; rx_idle_pending=false;
               }
       
-              void set_outgoing_bit()
+              // number of bits from tx_bit_counter up to the next line 
+              // transition, or up to the end of the frame
+              uint32_t get_outgoing_run()
               {
-                if((tx_data>>tx_bit_counter) & 1) 
-                  PIO_Set(tx_pio_p,tx_mask);
-                else PIO_Clear(tx_pio_p,tx_mask);
+                register uint32_t bits=tx_data>>tx_bit_counter;
+
+                // NOTE: the bits beyond the stop bits are zero, so a 
+                // run of ones always ends at the end of the frame
+                return static_cast<uint32_t>(
+                  __builtin_ctz((bits & 1)? ~bits: bits)
+                );
+              }
+
+              // NOTE: the fraction of tick is carried over to the next
+              // deadline, so the deadlines do not drift 
+              void advance_tx_deadline(uint32_t bits)
+              {
+                uint32_t fraction=tx_deadline_fraction;
+
+                tx_deadline=tx_deadline+
+                  advance_fixed_ticks(bits,fixed_bit_ticks,fraction);
+                tx_deadline_fraction=fraction;
               }
       
               tc_timer_data* timer_p;
@@ -677,40 +2141,41 @@
               Pio* tx_pio_p;
               uint32_t tx_mask;
       
-              double tc_tick;
-              double bit_time;
-              double frame_time;
+              uint32_t fixed_bit_ticks;
               uint32_t bit_ticks;
               uint32_t bit_1st_half;
               uint32_t bit_1st_quarter;
+
+              // NOTE: with deadline timing the TC counter runs freely
+              // and RC is reprogrammed to the earliest pending rx/tx
+              // deadline, instead of interrupting each quarter of bit
+              bool deadline_timing;
+              rx_decoder_codes rx_decoder;
+              tx_encoder_codes tx_encoder;
       
               // serial protocol
               uint32_t bit_rate;
-              data_bit_codes data_bits;
-              parity_codes parity;
-              stop_bit_codes stop_bits;
-              uint32_t rx_frame_bits;
-              uint32_t tx_frame_bits;
-              uint32_t parity_bit_pos;
-              uint32_t first_stop_bit_pos;
-              uint32_t data_mask;
-      
-              // rx data
-              circular_fifo<uint32_t,RX_BUFFER_LENGTH> rx_buffer;
-              volatile uint32_t rx_data;
-              volatile uint32_t rx_bit_counter;
-              volatile uint32_t rx_bit;
-              volatile rx_status_codes rx_status;
-              volatile uint32_t rx_data_status;
-              //volatile bool rx_at_end_quarter;
-              volatile uint32_t rx_interrupt_counter;
-      
-              // tx data
-              fifo<uint32_t,TX_BUFFER_LENGTH> tx_buffer;
-              volatile uint32_t tx_data;
-              volatile uint32_t tx_bit_counter;
-              volatile tx_status_codes tx_status;
-              volatile uint32_t tx_interrupt_counter;
+
+              #ifdef SOFT_UART_ISR_PROFILING
+                isr_profile tc_profile;
+                isr_profile rx_profile;
+              #endif
+      
+              // rx edge timestamps (EDGE_TIMESTAMPS & INPUT_CAPTURE)
+              uint32_t rx_edge_ticks[MAX_RX_EDGES];
+              volatile uint32_t rx_edge_levels;
+              volatile uint32_t rx_edges;
+              volatile uint32_t rx_last_level;
+              uint32_t rx_frame_ticks;
+              volatile uint32_t rx_deadline;
+
+              // idle line detection with deadline timing
+              uint32_t rx_idle_ticks;
+              volatile bool rx_idle_pending;
+      
+              // tx deadlines
+              volatile uint32_t tx_deadline;
+              volatile uint32_t tx_deadline_fraction;
             };
         
             static _uart_ctx_ _ctx_;
@@ -721,12 +2186,13 @@
         template<
           timer_ids TIMER,
           size_t RX_BUFFER_LENGTH,
-          size_t TX_BUFFER_LENGTH
+          size_t TX_BUFFER_LENGTH,
+          typename FRAME_FORMAT = runtime_frame_format
         > class serial: public HardwareSerial 
         {
           public:
       
-            typedef uart<TIMER,RX_BUFFER_LENGTH,TX_BUFFER_LENGTH> raw_uart;
+            typedef uart<TIMER,RX_BUFFER_LENGTH,TX_BUFFER_LENGTH,FRAME_FORMAT> raw_uart;
       
             serial() 
             { 
@@ -757,7 +2223,9 @@
               uint32_t bit_rate = bit_rates::DEFAULT_BIT_RATE,
               data_bit_codes the_data_bits = data_bit_codes::EIGHT_BITS,
               parity_codes the_parity = parity_codes::NO_PARITY,
-              stop_bit_codes the_stop_bits = stop_bit_codes::ONE_STOP_BIT
+              stop_bit_codes the_stop_bits = stop_bit_codes::ONE_STOP_BIT,
+              rx_decoder_codes the_rx_decoder = rx_decoder_codes::OVERSAMPLING,
+              tx_encoder_codes the_tx_encoder = tx_encoder_codes::PER_BIT
             )
             {
               _tc_uart_.config(
@@ -766,7 +2234,9 @@
                 bit_rate,
                 the_data_bits,
                 the_parity,
-                the_stop_bits
+                the_stop_bits,
+                the_rx_decoder,
+                the_tx_encoder
               );
             }
       
@@ -780,7 +2250,9 @@
               data_bit_codes the_data_bits = data_bit_codes::EIGHT_BITS,
               parity_codes the_parity = parity_codes::NO_PARITY,
               stop_bit_codes the_stop_bits = stop_bit_codes::ONE_STOP_BIT,
-              bool in_rx_mode = true
+              bool in_rx_mode = true,
+              rx_decoder_codes the_rx_decoder = rx_decoder_codes::OVERSAMPLING,
+              tx_encoder_codes the_tx_encoder = tx_encoder_codes::PER_BIT
             )
             {
               return _tc_uart_.half_duplex_config(
@@ -789,7 +2261,9 @@
                 the_data_bits,
                 the_parity,
                 the_stop_bits,
-                in_rx_mode
+                in_rx_mode,
+                the_rx_decoder,
+                the_tx_encoder
               );
             }
       
@@ -834,6 +2308,56 @@
               return _last_data_; 
             }
       
+            // NOTE: it reads up to length bytes without waiting, 
+            // returning how many were read, with statuses the erroneous
+            // data is also read, with its status on statuses (like 
+            // get_last_data_status()), otherwise it is discarded
+            size_t read(
+              uint8_t* buffer,
+              size_t length,
+              uint32_t* statuses = nullptr
+            )
+            {
+              size_t count=0;
+
+              if(_peek_data_valid_ && length)
+              {
+                _peek_data_valid_=false;
+                buffer[count]=static_cast<uint8_t>(_last_data_);
+                if(statuses) statuses[count]=_last_data_status_;
+                count++;
+              }
+
+              if(statuses)
+                return count+_tc_uart_.get_rx_data(
+                  buffer+count,length-count,statuses+count
+                );
+
+              uint32_t chunk_statuses[RX_CHUNK_FRAMES];
+              while(count<length)
+              {
+                size_t chunk=length-count;
+                if(chunk>RX_CHUNK_FRAMES) chunk=RX_CHUNK_FRAMES;
+
+                size_t frames=
+                  _tc_uart_.get_rx_data(buffer+count,chunk,chunk_statuses);
+                if(!frames) break;
+
+                size_t valid=count;
+                for(size_t i=0; i<frames; i++)
+                {
+                  _last_data_status_=chunk_statuses[i];
+                  if(
+                    _tc_uart_.data_available(_last_data_status_) &&
+                    !_tc_uart_.bad_status(_last_data_status_)
+                  ) buffer[valid++]=buffer[count+i];
+                }
+                count=valid;
+              }
+
+              return count;
+            }
+
             bool data_available() { return _tc_uart_.data_available(_last_data_status_); }
       
             bool data_lost() { return _tc_uart_.data_lost(_last_data_status_); }
@@ -844,6 +2368,39 @@
             
             bool bad_parity() { return _tc_uart_.bad_parity(_last_data_status_); }
             bool bad_stop_bit() { return _tc_uart_.bad_stop_bit(_last_data_status_); }
+
+            // NOTE: read() returns -1 when it reads an idle line mark
+            bool idle_line() { return _tc_uart_.idle_line(_last_data_status_); }
+
+            // NOTE: zero-copy reception (see uart::peek_contiguous()),
+            // the frames are not validated, and it must not be mixed 
+            // with peek(), as the byte peeked is no longer in the buffer
+            size_t peek_contiguous(const frame_t*& frames)
+            { return _tc_uart_.peek_contiguous(frames); }
+
+            bool consume(size_t n) { return _tc_uart_.consume(n); }
+
+            uint32_t get_frame_data(frame_t frame)
+            { return _tc_uart_.get_frame_data(frame); }
+
+            uint32_t get_frame_status(frame_t frame)
+            { return _tc_uart_.get_frame_status(frame); }
+
+            // for the statuses given by the bulk read()
+            bool bad_status(uint32_t status) { return _tc_uart_.bad_status(status); }
+            bool bad_start_bit(uint32_t status) { return _tc_uart_.bad_start_bit(status); }
+            bool bad_parity(uint32_t status) { return _tc_uart_.bad_parity(status); }
+            bool bad_stop_bit(uint32_t status) { return _tc_uart_.bad_stop_bit(status); }
+            bool idle_line(uint32_t status) { return _tc_uart_.idle_line(status); }
+
+            // NOTE: idle line detection (see uart::set_rx_idle_timeout()),
+            // the idle line marks are only read by read() with statuses, 
+            // or one by one
+            void set_rx_idle_timeout(uint32_t bits) 
+            { _tc_uart_.set_rx_idle_timeout(bits); }
+
+            uint32_t get_rx_idle_timeout() 
+            { return _tc_uart_.get_rx_idle_timeout(); }
             
             void flush(void) override { _tc_uart_.flush(); } 
             
@@ -851,7 +2408,7 @@
             
             size_t write(uint8_t data) 
             {
-              while(!available_for_write()) { /* nothing */ }
+              while(!available_for_write()) { busy_wait(); }
       
               return (
                   (_tc_uart_.set_tx_data(static_cast<uint32_t>(data)))? 
@@ -861,13 +2418,33 @@
       
             size_t write(uint32_t data) 
             {
-              while(!available_for_write()) { /* nothing */ }
+              while(!available_for_write()) { busy_wait(); }
       
               return (
                   (_tc_uart_.set_tx_data(data))? 
                     1: 0 
               ); 
             }
+
+            // NOTE: the block is pushed on the TX buffer in as few 
+            // chunks as possible, waiting only while the buffer is full, 
+            // as Print functions expect everything to be written
+            size_t write(const uint8_t* buffer,size_t size) override
+            {
+              size_t written=0;
+              while(written<size)
+              {
+                written+=_tc_uart_.set_tx_data(buffer+written,size-written);
+                if(written<size) { busy_wait(); }
+              }
+
+              return written;
+            }
+
+            // NOTE: it returns the number of bytes written, without 
+            // waiting for room on the TX buffer
+            size_t try_write(const uint8_t* buffer,size_t size)
+            { return _tc_uart_.set_tx_data(buffer,size); }
       
             mode_codes get_mode() { return _tc_uart_.get_mode(); }
       
@@ -879,6 +2456,18 @@
             double get_bit_time() { return _tc_uart_.get_bit_time(); }
             double get_frame_time() { return _tc_uart_.get_frame_time(); }
             timer_ids get_timer() { return _tc_uart_.get_timer(); }
+
+            link_statistics get_link_statistics() 
+            { return _tc_uart_.get_link_statistics(); }
+            void reset_link_statistics() { _tc_uart_.reset_link_statistics(); }
+
+            #ifdef SOFT_UART_ISR_PROFILING
+              isr_profile get_tc_isr_profile() 
+              { return _tc_uart_.get_tc_isr_profile(); }
+              isr_profile get_rx_isr_profile() 
+              { return _tc_uart_.get_rx_isr_profile(); }
+              void reset_isr_profiles() { _tc_uart_.reset_isr_profiles(); }
+            #endif
       
             using Print::write; // pull in write(str) and write(buf, size) from Print
             operator bool() override { return true; } 
@@ -896,29 +2485,35 @@
         template<
           timer_ids TIMER,
           size_t RX_BUFFER_LENGTH,
-          size_t TX_BUFFER_LENGTH
+          size_t TX_BUFFER_LENGTH,
+          typename FRAME_FORMAT
         > typename uart<
           TIMER,
           RX_BUFFER_LENGTH,
-          TX_BUFFER_LENGTH
+          TX_BUFFER_LENGTH,
+          FRAME_FORMAT
         >::_uart_ctx_ 
-          uart<TIMER,RX_BUFFER_LENGTH,TX_BUFFER_LENGTH>::_ctx_;
+          uart<TIMER,RX_BUFFER_LENGTH,TX_BUFFER_LENGTH,FRAME_FORMAT>::_ctx_;
       
         template<
           timer_ids TIMER,
           size_t RX_BUFFER_LENGTH,
-          size_t TX_BUFFER_LENGTH
+          size_t TX_BUFFER_LENGTH,
+          typename FRAME_FORMAT
         > return_codes uart<
           TIMER,
           RX_BUFFER_LENGTH,
-          TX_BUFFER_LENGTH
+          TX_BUFFER_LENGTH,
+          FRAME_FORMAT
         >::_uart_ctx_::config(
           uint32_t the_rx_pin,
           uint32_t the_tx_pin,
           uint32_t the_bit_rate,
           data_bit_codes the_data_bits,
           parity_codes the_parity,
-          stop_bit_codes the_stop_bits
+          stop_bit_codes the_stop_bits,
+          rx_decoder_codes the_rx_decoder,
+          tx_encoder_codes the_tx_encoder
         )
         {
           if(
@@ -931,46 +2526,79 @@
           
           // NOTE: we will be using the fastest clock for TC ticks
           // just using a prescaler of 2
-          tc_tick=double(1)/double((VARIANT_MCK)>>1);
-          bit_time=double(1)/double(bit_rate);
+          fixed_bit_ticks=get_fixed_bit_ticks((VARIANT_MCK)>>1,bit_rate);
         
-          bit_ticks=static_cast<uint32_t>(bit_time/tc_tick);
-          bit_1st_half=(bit_ticks>>1);
-          bit_1st_quarter=(bit_ticks>>2);
+          bit_ticks=get_half_bit_ticks(fixed_bit_ticks,2);
+          bit_1st_half=get_half_bit_ticks(fixed_bit_ticks,1);
+          bit_1st_quarter=(fixed_bit_ticks+(1<<(TICK_FRACTION_BITS+1)))>>
+            (TICK_FRACTION_BITS+2);
+          set_oversampling_bit_ticks(fixed_bit_ticks);
       
-          data_bits=the_data_bits; parity=the_parity; stop_bits=the_stop_bits;
-      
-          // reception frame length in bits
-          rx_frame_bits=1 + // the start bit
-            static_cast<uint32_t>(data_bits) + // the data bits
-            ((parity!=parity_codes::NO_PARITY)? 1: 0) + // the parity?
-            1; // for reception we ONLY consider one stop bit
-      
-          // transmission frame length in bits
-          tx_frame_bits=rx_frame_bits;
-          if(stop_bits==stop_bit_codes::TWO_STOP_BITS) 
+          format.set(the_data_bits,the_parity,the_stop_bits);
+
+          #ifdef SOFT_UART_ISR_PROFILING
+            SOFT_UART_CYCLE_SOURCE::enable();
+            tc_profile.reset(); rx_profile.reset();
+          #endif
+
+          // ticks from the start bit edge to the middle of the stop bit
+          rx_frame_ticks=
+            get_half_bit_ticks(fixed_bit_ticks,(format.rx_frame_bits<<1)-1);
+
+          // NOTE: only TIOA can load RA/RB on its edges, so the
+          // capture decoder needs the TIOA pin of the channel itself
+          if(
+            (the_rx_decoder==rx_decoder_codes::INPUT_CAPTURE) &&
+            (
+              (
+                static_cast<uint32_t>(
+                  g_APinDescription[the_rx_pin].ulTCChannel
+                )!=(static_cast<uint32_t>(TIMER)<<1)
+              ) || 
+              (
+                (g_APinDescription[the_rx_pin].ulPinType!=PIO_PERIPH_A) &&
+                (g_APinDescription[the_rx_pin].ulPinType!=PIO_PERIPH_B)
+              )
+            )
+          ) return return_codes::BAD_CAPTURE_PIN;
+
+          if(
+            (the_tx_encoder!=tx_encoder_codes::PER_BIT) &&
+            (the_rx_decoder==rx_decoder_codes::OVERSAMPLING)
+          ) return return_codes::BAD_TX_ENCODER;
+
+          // NOTE: WAVEFORM needs the channel in waveform mode, so it
+          // can not share it with the capture decoder, and the TIOA 
+          // pin of the channel itself as TX pin
+          if(the_tx_encoder==tx_encoder_codes::WAVEFORM)
           {
-            // for transmission we DO consider also the second stop bit
-            tx_frame_bits++; 
+            if(the_rx_decoder==rx_decoder_codes::INPUT_CAPTURE)
+              return return_codes::BAD_TX_ENCODER;
+
+            if(
+              (
+                static_cast<uint32_t>(
+                  g_APinDescription[the_tx_pin].ulTCChannel
+                )!=(static_cast<uint32_t>(TIMER)<<1)
+              ) || 
+              (
+                (g_APinDescription[the_tx_pin].ulPinType!=PIO_PERIPH_A) &&
+                (g_APinDescription[the_tx_pin].ulPinType!=PIO_PERIPH_B)
+              )
+            ) return return_codes::BAD_WAVEFORM_PIN;
           }
+
+          rx_decoder=the_rx_decoder;
+          tx_encoder=the_tx_encoder;
+          deadline_timing=(rx_decoder!=rx_decoder_codes::OVERSAMPLING);
       
-          frame_time=tx_frame_bits*bit_time;
-      
-          parity_bit_pos=1 + // the start bit
-            static_cast<uint32_t>(data_bits); // the data bits
-      
-          first_stop_bit_pos=parity_bit_pos +
-            ((parity!=parity_codes::NO_PARITY)? 1: 0); // the parity?
-      
-          data_mask=(1<<static_cast<uint32_t>(data_bits))-1;
-      
+          reset_engine();
+
           rx_pin=the_rx_pin;
           rx_pio_p=g_APinDescription[rx_pin].pPort;
           rx_mask=g_APinDescription[rx_pin].ulPin;
-          rx_status=rx_status_codes::LISTENING;
-          rx_data_status=rx_data_status_codes::NO_DATA_AVAILABLE;
-          rx_buffer.reset();
-          rx_interrupt_counter=0;
+          rx_idle_ticks=0; rx_idle_pending=false;
+          rx_edges=0;
       
           rx_irq=(
             (rx_pio_p==PIOA)? 
@@ -984,14 +2612,50 @@
           tx_pin=the_tx_pin;
           tx_pio_p=g_APinDescription[tx_pin].pPort;
           tx_mask=g_APinDescription[tx_pin].ulPin;
-          tx_status=tx_status_codes::IDLE;
-          tx_buffer.reset();
-          tx_interrupt_counter=0;
       
           // PMC settings
           pmc_set_writeprotect(0);
           pmc_enable_periph_clk(uint32_t(timer_p->irq));
         
+          if(deadline_timing)
+          {
+            // the counter runs freely (no reset on RC compare), it is
+            // used for timestamping and RC for the next deadline
+            if(rx_decoder==rx_decoder_codes::INPUT_CAPTURE)
+              // capture mode: RA loaded on falling edges of TIOA,
+              // and RB on rising ones
+              TC_Configure(
+                timer_p->tc_p,
+                timer_p->channel,
+                TC_CMR_TCCLKS_TIMER_CLOCK1 |
+                TC_CMR_LDRA_FALLING |
+                TC_CMR_LDRB_RISING
+              );
+            else
+              // NOTE: with WAVEFORM, the software trigger issued when
+              // starting the channel sets TIOA (the idle line level)
+              TC_Configure(
+                timer_p->tc_p,
+                timer_p->channel,
+                TC_CMR_TCCLKS_TIMER_CLOCK1 |
+                TC_CMR_WAVE |
+                TC_CMR_WAVSEL_UP |
+                (
+                  (tx_encoder==tx_encoder_codes::WAVEFORM)? 
+                    TC_CMR_ASWTRG_SET: 0
+                )
+              );
+            disable_tc_ra_interrupt();
+            disable_tc_rc_interrupt();
+            disable_tc_capture_interrupts();
+
+            config_rx_interrupt();
+            config_tc_interrupt();
+            start_tc_interrupts();
+
+            return return_codes::EVERYTHING_OK;
+          }
+
           // timing setings
           TC_Configure(
             timer_p->tc_p,
@@ -1006,7 +2670,8 @@
       
           //TC_SetRC(timer_p->tc_p,timer_p->channel,bit_ticks);
           //TC_SetRC(timer_p->tc_p,timer_p->channel,bit_1st_half);
-          TC_SetRC(timer_p->tc_p,timer_p->channel,bit_1st_quarter);
+          // NOTE: RC is set for each quarter of bit once started
+          TC_SetRC(timer_p->tc_p,timer_p->channel,bit_1st_quarter-1);
           //disable_tc_rc_interrupt();
           enable_tc_rc_interrupt();
       
@@ -1020,224 +2685,421 @@
         template<
           timer_ids TIMER,
           size_t RX_BUFFER_LENGTH,
-          size_t TX_BUFFER_LENGTH
+          size_t TX_BUFFER_LENGTH,
+          typename FRAME_FORMAT
         > void uart<
           TIMER,
           RX_BUFFER_LENGTH,
-          TX_BUFFER_LENGTH
+          TX_BUFFER_LENGTH,
+          FRAME_FORMAT
         >::_uart_ctx_::tc_interrupt(
           uint32_t the_status
         )
         {
-          // RC compare interrupt
+          if(deadline_timing)
+          {
+            if(the_status & (TC_SR_LDRAS|TC_SR_LDRBS))
+              capture_interrupt(the_status);
+
+            if((the_status & TC_SR_CPAS) && is_enabled_ra_interrupt())
+              waveform_interrupt();
+
+            if((the_status & TC_SR_CPCS) && is_enabled_rc_interrupt())
+              deadline_interrupt();
+            return;
+          }
+
+          // RC compare interrupt, each quarter of bit
           if((the_status & TC_SR_CPCS) && is_enabled_rc_interrupt())
+            oversampling_interrupt();
+        }
+        
+        template<
+          timer_ids TIMER,
+          size_t RX_BUFFER_LENGTH,
+          size_t TX_BUFFER_LENGTH,
+          typename FRAME_FORMAT
+        > void uart<
+          TIMER,
+          RX_BUFFER_LENGTH,
+          TX_BUFFER_LENGTH,
+          FRAME_FORMAT
+        >::_uart_ctx_::rx_interrupt()
+        {
+          if(rx_decoder==rx_decoder_codes::EDGE_TIMESTAMPS)
           {
-            // rx code
-            if(rx_status==rx_status_codes::RECEIVING)
-            {
-              if(rx_interrupt_counter==1)
-              {
-                get_incoming_bit(); 
-                rx_bit_counter++;
-                if(rx_bit_counter==rx_frame_bits)
-                {
-                  if(stop_bits==stop_bit_codes::TWO_STOP_BITS)
-                    get_incoming_bit();
-      
-                  if(tx_status==tx_status_codes::IDLE) stop_tc_interrupts(); 
-      
-                  update_rx_data_buffer();
+            register uint32_t now=get_tc_counter();
+            rx_edge(now,read_rx_pin());
+            return;
+          }
+
+          oversampling_rx_edge();
+        }
       
-                  rx_status=rx_status_codes::LISTENING;
-                }
-              }
-              rx_interrupt_counter=(rx_interrupt_counter+1)&0x3;
-            }
+        template<
+          timer_ids TIMER,
+          size_t RX_BUFFER_LENGTH,
+          size_t TX_BUFFER_LENGTH,
+          typename FRAME_FORMAT
+        > void uart<
+          TIMER,
+          RX_BUFFER_LENGTH,
+          TX_BUFFER_LENGTH,
+          FRAME_FORMAT
+        >::_uart_ctx_::start_tx()
+        {
+          if(!deadline_timing) { start_oversampling_tx(); return; }
+
+          // NOTE: the transmission is only kicked off when idle, 
+          // otherwise the interrupt handler pops the data just pushed
+          if(tx_status!=tx_status_codes::IDLE) return;
+
+          interrupt_guard guard;
+
+          // NOTE: the interrupt handler may have sent the data just 
+          // pushed (going idle again) before disabling the interrupts,
+          // so the status is checked again, and nothing is sent if
+          // the TX buffer is empty
+          if(tx_status!=tx_status_codes::IDLE) return;
+
+          if(tx_encoder==tx_encoder_codes::WAVEFORM)
+          {
+            // the start bit edge is the first one programmed on RA
+            frame_t frame_to_send;
+            if(!pop_tx_frame(frame_to_send)) return;
+
+            tx_data=frame_to_send; tx_bit_counter=0;
+            tx_deadline=get_tc_counter()+bit_1st_quarter;
+            tx_deadline_fraction=0;
+            schedule_waveform_edge(0);
+            enable_tc_ra_interrupt();
+            tx_status=tx_status_codes::SENDING;
+            return;
+          }
+
+          if(!tx_buffer.items()) return;
+
+          // NOTE: tx_bit_counter at the end of the frame makes
+          // the first deadline pop the data just pushed 
+          tx_bit_counter=format.tx_frame_bits;
+          tx_deadline=get_tc_counter()+bit_1st_quarter;
+          tx_deadline_fraction=0;
+          tx_status=tx_status_codes::SENDING;
+          schedule_next_deadline();
+        }
       
+        template<
+          timer_ids TIMER,
+          size_t RX_BUFFER_LENGTH,
+          size_t TX_BUFFER_LENGTH,
+          typename FRAME_FORMAT
+        > bool uart<
+          TIMER,
+          RX_BUFFER_LENGTH,
+          TX_BUFFER_LENGTH,
+          FRAME_FORMAT
+        >::_uart_ctx_::schedule_next_deadline()
+        {
+          // NOTE: WAVEFORM TX deadlines are programmed on RA
+          register bool tx_pending=(
+            (tx_status==tx_status_codes::SENDING) &&
+            (tx_encoder!=tx_encoder_codes::WAVEFORM)
+          );
+          register bool rx_pending=(
+            (rx_status==rx_status_codes::RECEIVING) || rx_idle_pending
+          );
+
+          if(!tx_pending && !rx_pending)
+          { disable_tc_rc_interrupt(); return true; }
+
+          register uint32_t now=get_tc_counter();
+          register uint32_t deadline=(tx_pending)? tx_deadline: rx_deadline;
+          if(
+            tx_pending && rx_pending &&
+            (static_cast<int32_t>(rx_deadline-now)<
+              static_cast<int32_t>(tx_deadline-now))
+          ) deadline=rx_deadline;
+
+          TC_SetRC(timer_p->tc_p,timer_p->channel,deadline);
+          enable_tc_rc_interrupt();
+
+          // NOTE: if the counter has already gone past the deadline
+          // the RC compare would not happen until the counter wraps
+          // around, the caller must serve the deadline right away
+          return !is_due(deadline,get_tc_counter());
+        }
+
+        template<
+          timer_ids TIMER,
+          size_t RX_BUFFER_LENGTH,
+          size_t TX_BUFFER_LENGTH,
+          typename FRAME_FORMAT
+        > void uart<
+          TIMER,
+          RX_BUFFER_LENGTH,
+          TX_BUFFER_LENGTH,
+          FRAME_FORMAT
+        >::_uart_ctx_::deadline_interrupt()
+        {
+          do
+          {
+            register uint32_t now=get_tc_counter();
+
             // tx code
-            if(tx_status==tx_status_codes::SENDING)
+            if(
+              (tx_status==tx_status_codes::SENDING) && 
+              (tx_encoder!=tx_encoder_codes::WAVEFORM) &&
+              is_due(tx_deadline,now)
+            )
             {
-              if(tx_interrupt_counter==0)
+              if(tx_bit_counter>=format.tx_frame_bits)
               {
-                if(tx_bit_counter>=tx_frame_bits)
-                {
-                  uint32_t data_to_send;
-                  if(tx_buffer.pop(data_to_send)) 
-                  { 
-                    tx_data=data_to_send; tx_bit_counter=0; 
-                    set_outgoing_bit(); tx_bit_counter++;
-                  }
-                  else
-                  {
-                    if(rx_status==rx_status_codes::LISTENING) 
-                      stop_tc_interrupts(); 
-      
-                    tx_status=tx_status_codes::IDLE;
-                  }
-                }
-                else { set_outgoing_bit(); tx_bit_counter++; }
+                frame_t data_to_send;
+                if(pop_tx_frame(data_to_send)) 
+                { tx_data=data_to_send; tx_bit_counter=0; }
+                else tx_status=tx_status_codes::IDLE;
+              }
+
+              if(tx_status==tx_status_codes::SENDING)
+              {
+                // NOTE: with RUN_LENGTH the line keeps its level up
+                // to the next transition, so that is the next deadline
+                register uint32_t bits=
+                  (tx_encoder==tx_encoder_codes::RUN_LENGTH)? 
+                    get_outgoing_run(): 1;
+
+                set_outgoing_bit(); 
+                tx_bit_counter=tx_bit_counter+bits;
+                advance_tx_deadline(bits);
               }
-              tx_interrupt_counter=(tx_interrupt_counter+1)&0x3;
             }
+
+            // rx code
+            if(
+              (rx_status==rx_status_codes::RECEIVING) && 
+              is_due(rx_deadline,now)
+            )
+            {
+              decode_rx_edges();
+              rx_status=rx_status_codes::LISTENING;
+
+              // NOTE: the idle line deadline counts from the middle of
+              // the stop bit
+              if(rx_idle_ticks)
+              { rx_deadline=rx_deadline+rx_idle_ticks; rx_idle_pending=true; }
+            }
+            else if(rx_idle_pending && is_due(rx_deadline,now))
+            { rx_idle_pending=false; push_rx_idle_mark(); }
+          } while(!schedule_next_deadline());
+        }
+
+        template<
+          timer_ids TIMER,
+          size_t RX_BUFFER_LENGTH,
+          size_t TX_BUFFER_LENGTH,
+          typename FRAME_FORMAT
+        > void uart<
+          TIMER,
+          RX_BUFFER_LENGTH,
+          TX_BUFFER_LENGTH,
+          FRAME_FORMAT
+        >::_uart_ctx_::schedule_waveform_edge(
+          uint32_t level
+        )
+        {
+          // NOTE: if it is too late to program the edge, it is delayed
+          // instead of waiting for the counter to wrap around, which 
+          // is harmless on the frame boundaries (the start bit, or the
+          // end of the frame), as the line is idle, but in the middle
+          // of a frame it would stretch a bit, so the frame is aborted
+          // instead: the line is set idle (mark) up to the end of the
+          // frame, and the frame is counted as aborted
+          register uint32_t now=get_tc_counter();
+          if(is_due(tx_deadline,now+MIN_WAVEFORM_LEAD_TICKS))
+          {
+            if((tx_bit_counter>0) && (tx_bit_counter<format.tx_frame_bits))
+            {
+              tx_data=tx_data|((1<<format.tx_frame_bits)-1);
+              level=1;
+              statistics.tx_aborted_frames++;
+            }
+
+            tx_deadline=now+bit_1st_quarter; tx_deadline_fraction=0; 
           }
+
+          // NOTE: the TC sets or clears TIOA by itself on the next RA
+          // compare, so the line level does not depend on the latency
+          // of this interrupt, it just has to program the next edge
+          // before it is due
+          register uint32_t cmr=
+            timer_p->tc_p->TC_CHANNEL[timer_p->channel].TC_CMR;
+          timer_p->tc_p->TC_CHANNEL[timer_p->channel].TC_CMR=
+            (cmr & ~TC_CMR_ACPA_Msk) | 
+            ((level)? TC_CMR_ACPA_SET: TC_CMR_ACPA_CLEAR);
+
+          TC_SetRA(timer_p->tc_p,timer_p->channel,tx_deadline);
         }
-        
+
         template<
           timer_ids TIMER,
           size_t RX_BUFFER_LENGTH,
-          size_t TX_BUFFER_LENGTH
+          size_t TX_BUFFER_LENGTH,
+          typename FRAME_FORMAT
         > void uart<
           TIMER,
           RX_BUFFER_LENGTH,
-          TX_BUFFER_LENGTH
-        >::_uart_ctx_::rx_interrupt()
+          TX_BUFFER_LENGTH,
+          FRAME_FORMAT
+        >::_uart_ctx_::waveform_interrupt()
+        {
+          frame_t data_to_send;
+
+          // NOTE: the line has just been set to the level of the run
+          // starting at tx_bit_counter, the next edge is at its end
+          if(tx_bit_counter<format.tx_frame_bits)
+          {
+            register uint32_t bits=get_outgoing_run();
+            tx_bit_counter=tx_bit_counter+bits;
+            advance_tx_deadline(bits);
+
+            if(tx_bit_counter<format.tx_frame_bits)
+              schedule_waveform_edge((tx_data>>tx_bit_counter)&1);
+            else if(pop_tx_frame(data_to_send))
+            {
+              // the next start bit follows right after the stop bits
+              tx_data=data_to_send; tx_bit_counter=0;
+              schedule_waveform_edge(0);
+            }
+            // the line stays high, but we need to know when the
+            // frame ends
+            else schedule_waveform_edge(1);
+
+            return;
+          }
+
+          // end of the last frame
+          if(pop_tx_frame(data_to_send))
+          {
+            tx_data=data_to_send; tx_bit_counter=0;
+            tx_deadline=get_tc_counter()+bit_1st_quarter;
+            tx_deadline_fraction=0;
+            schedule_waveform_edge(0);
+          }
+          else
+          {
+            disable_tc_ra_interrupt();
+            tx_status=tx_status_codes::IDLE;
+          }
+        }
+
+        template<
+          timer_ids TIMER,
+          size_t RX_BUFFER_LENGTH,
+          size_t TX_BUFFER_LENGTH,
+          typename FRAME_FORMAT
+        > void uart<
+          TIMER,
+          RX_BUFFER_LENGTH,
+          TX_BUFFER_LENGTH,
+          FRAME_FORMAT
+        >::_uart_ctx_::rx_edge(
+          uint32_t now,
+          uint32_t level
+        )
         {
-          register uint32_t sampled_bit=
-            PIO_Get(rx_pio_p,PIO_INPUT,rx_mask);
-      
           switch(rx_status)
           {
             case rx_status_codes::LISTENING:
-              if(!sampled_bit)
+              if(!level)
               {
                 rx_status=rx_status_codes::RECEIVING;
-                rx_data=rx_bit_counter=rx_bit=0;
-                rx_interrupt_counter=0;
-                
-                if(tx_status==tx_status_codes::IDLE) 
-                { start_tc_interrupts(); rx_interrupt_counter=1; }
-              } 
+                rx_idle_pending=false;
+                rx_edge_ticks[0]=now; rx_edge_levels=0; rx_edges=1;
+                rx_deadline=now+rx_frame_ticks;
+                schedule_next_deadline();
+              }
               break;
-              
+
             case rx_status_codes::RECEIVING:
-              rx_bit=sampled_bit;
+              if(rx_edges<MAX_RX_EDGES)
+              {
+                rx_edge_ticks[rx_edges]=now;
+                rx_edge_levels|=(level<<rx_edges);
+                rx_edges++;
+              }
               break;
           }
         }
-      
+
         template<
           timer_ids TIMER,
           size_t RX_BUFFER_LENGTH,
-          size_t TX_BUFFER_LENGTH
-        > uint32_t uart<
+          size_t TX_BUFFER_LENGTH,
+          typename FRAME_FORMAT
+        > void uart<
           TIMER,
           RX_BUFFER_LENGTH,
-          TX_BUFFER_LENGTH
-        >::_uart_ctx_::get_rx_data(
-          uint32_t& data
+          TX_BUFFER_LENGTH,
+          FRAME_FORMAT
+        >::_uart_ctx_::capture_interrupt(
+          uint32_t the_status
         )
         {
-          register uint32_t status;
-          register bool not_empty;
-          uint32_t data_received;
-          
-          {
-            interrupt_guard guard;
-            
-            status=(not_empty=rx_buffer.pop(data_received))?
-              rx_data_status_codes::DATA_AVAILABLE:
-              rx_data_status_codes::NO_DATA_AVAILABLE;
-          }
-      
-          if(!not_empty) return status;
-          
-          // checking start bit
-          status=(data_received & 1)?
-            status|rx_data_status_codes::BAD_START_BIT:
-            status&(~rx_data_status_codes::BAD_START_BIT);
-      
-          // cheking parity
-          if(parity!=parity_codes::NO_PARITY)
-          {
-            register uint32_t data_parity=get_even_parity(
-              (data_received>>1),
-              static_cast<uint32_t>(data_bits)
-            );
-      
-            if(parity==parity_codes::ODD_PARITY) 
-              data_parity=data_parity^1;
-      
-            register uint32_t received_parity=
-              (data_received>>parity_bit_pos) & 1;
-      
-            // verifying parity bit
-            status=(received_parity^data_parity)?
-                status|rx_data_status_codes::BAD_PARITY:
-                status&(~rx_data_status_codes::BAD_PARITY);
+          register bool falling=(the_status & TC_SR_LDRAS);
+          register bool rising=(the_status & TC_SR_LDRBS);
+
+          // NOTE: RA and RB are loaded alternately, so if both were 
+          // loaded since the last interrupt, the oldest one is the 
+          // edge that follows the last level captured
+          if(falling && rising && !rx_last_level)
+          { 
+            rx_edge(get_tc_rb(),1); rx_edge(get_tc_ra(),0);
+            rx_last_level=0;
+            return;
           }
-      
-          // checking stop bit
-          // NOTE: we only verify the first stop bit
-          status=((data_received>>first_stop_bit_pos) & 1)?
-            status&(~rx_data_status_codes::BAD_STOP_BIT):
-            status|rx_data_status_codes::BAD_STOP_BIT;
-      
-          // NOTE: in case of error, we put the received raw data
-          // on the high 16 bits of status
-          if(bad_status(status)) status=status|(data_received<<16);
-      
-          data=(data_received>>1)&data_mask;
-      
-          return status;
+
+          if(falling) { rx_edge(get_tc_ra(),0); rx_last_level=0; }
+          if(rising) { rx_edge(get_tc_rb(),1); rx_last_level=1; }
         }
-      
+
         template<
           timer_ids TIMER,
           size_t RX_BUFFER_LENGTH,
-          size_t TX_BUFFER_LENGTH
-        > bool uart<
+          size_t TX_BUFFER_LENGTH,
+          typename FRAME_FORMAT
+        > void uart<
           TIMER,
           RX_BUFFER_LENGTH,
-          TX_BUFFER_LENGTH
-        >::_uart_ctx_::set_tx_data(
-          uint32_t data
-        )
+          TX_BUFFER_LENGTH,
+          FRAME_FORMAT
+        >::_uart_ctx_::decode_rx_edges()
         {
-          // setting the data to send
-          uint32_t data_to_send=data&data_mask;
-         
-          // setting the parity bit
-          if(parity!=parity_codes::NO_PARITY)
-          {
-            register uint32_t data_parity=get_even_parity(
-              data_to_send,
-              static_cast<uint32_t>(data_bits)
-            );
-      
-            if(parity==parity_codes::ODD_PARITY) 
-              data_parity=data_parity^1;
-      
-            data_to_send=
-              (data_to_send<<1)|(data_parity<<parity_bit_pos);
-          }
-          else data_to_send=(data_to_send<<1);
-      
-          // setting the stop bits
-          if(stop_bits==stop_bit_codes::ONE_STOP_BIT)
-            data_to_send=data_to_send|(1<<first_stop_bit_pos);
-          else
-            data_to_send=data_to_send|(0x3<<first_stop_bit_pos);
-      
-          interrupt_guard guard;
-      
-          if(!tx_buffer.push(data_to_send))  
-            return false; // tx buffer full
-      
-          if(tx_status==tx_status_codes::IDLE)
+          // NOTE: each bit is sampled at its middle, taking the level
+          // set by the last edge before it, edge 0 is the start bit
+          register uint32_t start=rx_edge_ticks[0];
+          register uint32_t edge=0;
+          register uint32_t level=0;
+          register uint32_t data=0;
+
+          for(uint32_t bit=0; bit<format.rx_frame_bits; bit++)
           {
-            tx_buffer.pop(data_to_send); 
-            tx_data=data_to_send; tx_bit_counter=0; 
-            tx_interrupt_counter=0;
+            while(
+              (edge+1<rx_edges) && 
+              (
+                rx_edge_ticks[edge+1]-start<=
+                  get_bit_sample_ticks(fixed_bit_ticks,bit)
+              )
+            ) edge++;
+
+            level=(rx_edge_levels>>edge)&1;
+            data|=(level<<bit);
           }
-      
-          if(
-            (rx_status==rx_status_codes::LISTENING)
-            && (tx_status==tx_status_codes::IDLE) 
-          ) start_tc_interrupts();
-      
-          tx_status=tx_status_codes::SENDING;
-      
-          return true;
+
+          if(format.stop_bits==stop_bit_codes::TWO_STOP_BITS)
+            data|=(level<<format.rx_frame_bits);
+
+          rx_data=data;
+          update_rx_data_buffer();
         }
       
       } // namespace arduino_due
@@ -1256,6 +3118,17 @@
       {
         constexpr uint32_t NUM_DIGITAL_PINS=16;
 
+        // NOTE: GPT limits assumed for the timer frequency selection
+        // (16-bit timers and prescalers), and how many prescalers are
+        // tried looking for the lowest bit time error
+        constexpr uint32_t MAX_GPT_INTERVAL=0xFFFF;
+        constexpr uint32_t MAX_GPT_PRESCALER=0x10000;
+        constexpr uint32_t GPT_PRESCALER_CANDIDATES=16;
+
+        // NOTE: event flag broadcast when the line gets idle after a 
+        // frame, beyond the ChibiOS channel and serial driver flags
+        constexpr eventflags_t IDLE_LINE_DETECTED=(eventflags_t)(1<<15);
+
         class interrupt_guard
         {
           public:
@@ -1272,6 +3145,16 @@
             ~system_guard() { chSysUnlock(); }
         };
 
+        // NOTE: the threads woken up with the system locked are 
+        // rescheduled before unlocking it
+        class reschedule_guard
+        {
+          public:
+      
+            reschedule_guard() { chSysLock(); }
+            ~reschedule_guard() { chSchRescheduleS(); chSysUnlock(); }
+        };
+
         template<
           GPTDriver* TIMER,
           size_t RX_BUFFER_LENGTH,
@@ -1283,7 +3166,13 @@
             typedef decltype(GPIOA) gpio_port_t;
             //typedef stm32_gpio_t* gpio_port_t;
       
-            uart() { _mode_=mode_codes::INVALID_MODE; }
+            uart() 
+            { 
+              _mode_=mode_codes::INVALID_MODE; 
+
+              _channel_.vmt=&_channel_vmt_; _channel_.owner=this;
+              chEvtObjectInit(&_channel_.event);
+            }
       
             ~uart() { end(); }
         
@@ -1320,6 +3209,8 @@
                 ); 
       
               if(ret_code!=return_codes::EVERYTHING_OK) return ret_code;
+
+              { system_guard guard; _ctx_.events=&_channel_.event; }
                       
               // cofigure tx pin
               palSetPadMode(
@@ -1373,6 +3264,8 @@
                 ); 
       
               if(ret_code!=return_codes::EVERYTHING_OK) return ret_code;
+
+              { system_guard guard; _ctx_.events=&_channel_.event; }
       
               if(in_rx_mode)
               {
@@ -1472,8 +3365,17 @@
             size_t get_tx_buffer_length() { return TX_BUFFER_LENGTH; }
         
             uint32_t get_bit_rate() { return _ctx_.bit_rate; }
-            double get_bit_time() { return _ctx_.bit_time; }	
-            double get_frame_time() { return _ctx_.frame_time; }	
+
+            // NOTE: the timer frequency selected for the bit rate, and
+            // the residual error of the bit time in ppm (positive when
+            // the bits sent and sampled are longer than nominal)
+            uint32_t get_timer_frequency() 
+            { return _ctx_.gpt_config.frequency; }
+            int32_t get_bit_error_ppm() { return _ctx_.bit_error_ppm; }
+            double get_bit_time() 
+            { return double(1)/double(_ctx_.bit_rate); }	
+            double get_frame_time() 
+            { return double(_ctx_.format.tx_frame_bits)/double(_ctx_.bit_rate); }	
       
             uint32_t get_rx_data(uint32_t& data) 
             { 
@@ -1488,6 +3390,47 @@
                   )
               );
             }
+
+            // NOTE: it returns the number of frames read (up to length)
+            // without waiting, with their data on data (8 bits at most), 
+            // and their status on statuses (if not null)
+            size_t get_rx_data(
+              uint8_t* data,
+              size_t length,
+              uint32_t* statuses = nullptr
+            ) 
+            { 
+              return (
+                (
+                  (_mode_==mode_codes::FULL_DUPLEX) ||
+                  (_mode_==mode_codes::RX_MODE)
+                )? _ctx_.get_rx_data(data,length,statuses): 0
+              );
+            }
+
+            // NOTE: zero-copy reception, it gives the largest run of 
+            // frames received which can be read in place in the 
+            // reception buffer (up to its end), with their data and 
+            // status given by get_frame_data() and get_frame_status(),
+            // consume() pops the first n of them, returning false if 
+            // some could have been overwritten while being read
+            size_t peek_contiguous(const frame_t*& frames)
+            {
+              if(
+                (_mode_!=mode_codes::FULL_DUPLEX) &&
+                (_mode_!=mode_codes::RX_MODE)
+              ) { frames=nullptr; return 0; }
+
+              return _ctx_.rx_buffer.peek_contiguous(frames);
+            }
+
+            bool consume(size_t n) { return _ctx_.rx_buffer.consume(n); }
+
+            uint32_t get_frame_data(frame_t frame)
+            { return (frame>>1)&_ctx_.format.data_mask; }
+
+            uint32_t get_frame_status(frame_t frame)
+            { return _ctx_.get_rx_frame_status(frame); }
       
             bool data_available(uint32_t status)
             { return _ctx_.data_available(status); }
@@ -1506,6 +3449,20 @@
       
             bool bad_stop_bit(uint32_t status) 
             { return _ctx_.bad_stop_bit(status); }
+
+            bool idle_line(uint32_t status) 
+            { return _ctx_.idle_line(status); }
+
+            // NOTE: idle line detection, when the line stays idle for 
+            // bits bit times after a frame (counted from the middle of
+            // its stop bit), a mark is put on the RX buffer, which is 
+            // read as status IDLE_LINE, and IDLE_LINE_DETECTED is 
+            // broadcast on the event source, zero bits disable it (as 
+            // after configuring the object)
+            void set_rx_idle_timeout(uint32_t bits) 
+            { _ctx_.set_rx_idle_timeout(bits); }
+
+            uint32_t get_rx_idle_timeout() { return _ctx_.rx_idle_bits; }
       
             // is TX buffer full?
             bool is_tx_full() 
@@ -1539,25 +3496,190 @@
                 )? _ctx_.set_tx_data(data): false
               ); 
             }
+
+            // NOTE: data is 8 bits length, it returns the number of 
+            // frames pushed without waiting for room on the TX buffer
+            size_t set_tx_data(const uint8_t* data,size_t length) 
+            { 
+              return (
+                (
+                  (_mode_==mode_codes::FULL_DUPLEX) ||
+                  (_mode_==mode_codes::TX_MODE)
+                )? _ctx_.set_tx_data(data,length): 0
+              ); 
+            }
       
             tx_status_codes get_tx_status() { return _ctx_.get_tx_status(); }
+
+            // NOTE: a copy taken with interrupts disabled
+            link_statistics get_link_statistics()
+            { system_guard guard; return _ctx_.statistics; }
+
+            void reset_link_statistics()
+            { system_guard guard; _ctx_.statistics.reset(); }
       
             void flush() { _ctx_.flush(); }
       
             void flush_rx() { _ctx_.flush_rx(); }
+
+            // NOTE: blocking reception from a thread, it sleeps up to 
+            // timeout waiting for each byte (like ChibiOS queues), the
+            // thread is woken up by the timer callback, it returns the 
+            // number of bytes read, discarding the erroneous data
+            size_t read(uint8_t* data,size_t length,sysinterval_t timeout)
+            {
+              return (
+                (
+                  (_mode_==mode_codes::FULL_DUPLEX) ||
+                  (_mode_==mode_codes::RX_MODE)
+                )? _ctx_.read(data,length,timeout): 0
+              );
+            }
+
+            // NOTE: blocking transmission from a thread, it sleeps up 
+            // to timeout waiting for room on the TX buffer for each 
+            // byte, it returns the number of bytes pushed
+            size_t write(
+              const uint8_t* data,
+              size_t length,
+              sysinterval_t timeout
+            )
+            {
+              return (
+                (
+                  (_mode_==mode_codes::FULL_DUPLEX) ||
+                  (_mode_==mode_codes::TX_MODE)
+                )? _ctx_.write(data,length,timeout): 0
+              );
+            }
+
+            // NOTE: the uart as a ChibiOS channel, for using it with 
+            // chprintf(), chnReadTimeout(), chnWriteTimeout(), etc.
+            BaseChannel* get_channel() 
+            { return reinterpret_cast<BaseChannel*>(&_channel_); }
+
+            BaseSequentialStream* get_stream() 
+            { return reinterpret_cast<BaseSequentialStream*>(&_channel_); }
+
+            // NOTE: the event source of the object (the same given by 
+            // chnGetEventSource() on the channel), the timer callback 
+            // broadcasts on it CHN_INPUT_AVAILABLE (when the RX buffer
+            // was empty), SD_PARITY_ERROR, SD_FRAMING_ERROR (bad start
+            // or stop bit), SD_OVERRUN_ERROR, CHN_OUTPUT_EMPTY (when 
+            // the last frame on the TX buffer is popped), 
+            // CHN_TRANSMISSION_END and IDLE_LINE_DETECTED, so a thread
+            // can wait on several objects at once with chEvtWaitAny()
+            event_source_t* get_event_source() { return &_channel_.event; }
       
           private:
 
+            // NOTE: the layout of a ChibiOS BaseAsynchronousChannel 
+            // (with its event source), pointing back to its uart object
+            struct _channel_t
+            {
+              const BaseChannelVMT* vmt;
+              _base_asynchronous_channel_data
+              uart* owner;
+            };
+
+            static const BaseChannelVMT _channel_vmt_;
+
+            static uart* _owner_(void* instance)
+            { return reinterpret_cast<_channel_t*>(instance)->owner; }
+
+            static size_t _channel_write_(
+              void* instance,
+              const uint8_t* data,
+              size_t length
+            ) { return _owner_(instance)->write(data,length,TIME_INFINITE); }
+
+            static size_t _channel_read_(
+              void* instance,
+              uint8_t* data,
+              size_t length
+            ) { return _owner_(instance)->read(data,length,TIME_INFINITE); }
+
+            static msg_t _channel_put_(void* instance,uint8_t data)
+            { return _channel_putt_(instance,data,TIME_INFINITE); }
+
+            static msg_t _channel_get_(void* instance)
+            { return _channel_gett_(instance,TIME_INFINITE); }
+
+            static msg_t _channel_putt_(
+              void* instance,
+              uint8_t data,
+              sysinterval_t timeout
+            )
+            {
+              uart* the_uart=_owner_(instance);
+              return (
+                (
+                  (the_uart->_mode_==mode_codes::FULL_DUPLEX) ||
+                  (the_uart->_mode_==mode_codes::TX_MODE)
+                )? _ctx_.put(data,timeout): MSG_RESET
+              );
+            }
+
+            static msg_t _channel_gett_(void* instance,sysinterval_t timeout)
+            {
+              uart* the_uart=_owner_(instance);
+              return (
+                (
+                  (the_uart->_mode_==mode_codes::FULL_DUPLEX) ||
+                  (the_uart->_mode_==mode_codes::RX_MODE)
+                )? _ctx_.get(timeout): MSG_RESET
+              );
+            }
+
+            static size_t _channel_writet_(
+              void* instance,
+              const uint8_t* data,
+              size_t length,
+              sysinterval_t timeout
+            ) { return _owner_(instance)->write(data,length,timeout); }
+
+            static size_t _channel_readt_(
+              void* instance,
+              uint8_t* data,
+              size_t length,
+              sysinterval_t timeout
+            ) { return _owner_(instance)->read(data,length,timeout); }
+
+            // NOTE: there are no control operations
+            static msg_t _channel_ctl_(void*,unsigned int,void*)
+            { return MSG_OK; }
+
             static void _gpt_callback_(GPTDriver*)
-            { _ctx_.tc_interrupt(); }
+            { _ctx_.oversampling_interrupt(); }
 
             static const GPTConfig _gpt_config_;
 
             static void _rx_callback_(void* obj) 
-            { reinterpret_cast<uart*>(obj)->_ctx_.rx_interrupt(); }
-      
-            struct _uart_ctx_
+            { reinterpret_cast<uart*>(obj)->_ctx_.oversampling_rx_edge(); }
+      
+            // NOTE: the bit engine of the GPT on the uart core
+            struct _uart_ctx_: uart_core<
+              _uart_ctx_,
+              RX_BUFFER_LENGTH,
+              TX_BUFFER_LENGTH,
+              runtime_frame_format
+            >
             {
+              typedef uart_core<
+                _uart_ctx_,
+                RX_BUFFER_LENGTH,
+                TX_BUFFER_LENGTH,
+                runtime_frame_format
+              > core;
+
+              SOFT_UART_USING_CORE_NAMES;
+
+              _uart_ctx_()
+              {
+                chThdQueueObjectInit(&rx_waiting);
+                chThdQueueObjectInit(&tx_waiting);
+                events=nullptr;
+              }
       
               return_codes config(
                 gpio_port_t the_rx_port, uint32_t the_rx_pin,
@@ -1577,69 +3699,119 @@
 
                 // disabling reception
                 palDisablePadEvent(rx_port,rx_pin);
+
+                // waking up the threads waiting
+                {
+                  system_guard guard;
+                  chThdDequeueAllI(&rx_waiting,MSG_RESET);
+                  chThdDequeueAllI(&tx_waiting,MSG_RESET);
+                  events=nullptr;
+                  chSchRescheduleS();
+                }
               }
 
-              void tc_interrupt();
-              void rx_interrupt();
-      
-              uint32_t get_rx_data(uint32_t& data);
-      
-              int available()
+              // NOTE: it sets gpt_config, bit_1st_quarter, the ticks of
+              // a bit of the OVERSAMPLING engine and bit_error_ppm for 
+              // the bit rate
+              bool select_timer_frequency(uint32_t clock);
+
+              // the policy of the OVERSAMPLING engine of the core, the
+              // GPT is used with the I-class functions, as the engine 
+              // calls them with the system locked
+              typedef interrupt_guard isr_guard;
+              typedef reschedule_guard thread_guard;
+
+              void start_timer(uint32_t ticks)
               {
-                system_guard guard;
-                return rx_buffer.items();
+                if(TIMER->state==GPT_CONTINUOUS) gptStopTimerI(TIMER);
+                gptStartContinuousI(TIMER,ticks);
               }
-      
-              bool data_available(uint32_t status)
-              { 
-                return (
-                  status&(
-                    rx_data_status_codes::DATA_AVAILABLE|
-                    rx_data_status_codes::DATA_LOST
-                  )
-                ); 
+
+              // NOTE: the interval is changed for the period just begun,
+              // unless the counter has already gone past it (it would not
+              // end until the counter wraps around)
+              void set_timer_period(uint32_t ticks)
+              {
+                if(gptGetCounterX(TIMER)<ticks-1) 
+                  gptChangeIntervalI(TIMER,ticks);
               }
-      
-              bool data_lost(uint32_t status)
-              { return (status&rx_data_status_codes::DATA_LOST); }
-      
-              bool bad_status(uint32_t status)
+
+              void stop_timer() { gptStopTimerI(TIMER); }
+
+              uint32_t read_rx_pin()
+              { return (palReadPad(rx_port,rx_pin)==PAL_HIGH)? 1: 0; }
+
+              void write_tx_pin(uint32_t level)
               {
-                return (
-                  status&(
-                    rx_data_status_codes::BAD_START_BIT|
-                    rx_data_status_codes::BAD_PARITY|
-                    rx_data_status_codes::BAD_STOP_BIT
-                  )
-                );
+                if(level) palSetPad(tx_port,tx_pin);
+                else palClearPad(tx_port,tx_pin);
               }
+
+              void rx_frame_hook()
+              { chThdDequeueNextI(&rx_waiting,MSG_OK); broadcast_rx_flags(); }
+
+              void tx_frame_hook()
+              {
+                chThdDequeueNextI(&tx_waiting,MSG_OK); 
+                if(!tx_buffer.items()) broadcast_flags(CHN_OUTPUT_EMPTY);
+              }
+
+              void tx_end_hook() { broadcast_flags(CHN_TRANSMISSION_END); }
+
+              void rx_idle_hook() { broadcast_flags(IDLE_LINE_DETECTED); }
       
-              bool bad_start_bit(uint32_t status)
-              { return (status&rx_data_status_codes::BAD_START_BIT); }
-              
-              bool bad_parity(uint32_t status)
-              { return (status&rx_data_status_codes::BAD_PARITY); }
-              
-              bool bad_stop_bit(uint32_t status)
-              { return (status&rx_data_status_codes::BAD_STOP_BIT); }
-      
-              // is TX buffer full?
-              bool is_tx_full() 
-              { 
+              void start_tx() { start_oversampling_tx(); }
+
+              // NOTE: blocking I/O from threads, the timeout is for 
+              // each wait, and MSG_RESET is returned on end()
+              size_t read(uint8_t* data,size_t length,sysinterval_t timeout);
+              size_t write(
+                const uint8_t* data,
+                size_t length,
+                sysinterval_t timeout
+              );
+              msg_t get(sysinterval_t timeout);
+              msg_t put(uint8_t data,sysinterval_t timeout);
+
+              // NOTE: checking and sleeping is atomic, as the timer
+              // callback wakes up the thread with the system locked
+              msg_t wait_rx(sysinterval_t timeout)
+              {
                 system_guard guard;
-                return tx_buffer.is_full();
+                return (rx_buffer.items())? 
+                  MSG_OK: chThdEnqueueTimeoutS(&rx_waiting,timeout);
               }
-      
-              int available_for_write() 
-              { 
+
+              // NOTE: with the system locked, the flags of the frame 
+              // just received (whose status was found when pushing it)
+              // are only broadcast if some thread listens
+              void broadcast_rx_flags()
+              {
+                if(!events || !chEvtIsListeningI(events)) return;
+
+                eventflags_t flags=
+                  (data_lost(rx_data_status))?
+                    SD_OVERRUN_ERROR:
+                    ((rx_buffer.items()==1)? CHN_INPUT_AVAILABLE: 0);
+
+                if(bad_parity(rx_data_status)) flags|=SD_PARITY_ERROR;
+                if(bad_start_bit(rx_data_status) || bad_stop_bit(rx_data_status)) 
+                  flags|=SD_FRAMING_ERROR;
+
+                if(flags) chEvtBroadcastFlagsI(events,flags);
+              }
+
+              // NOTE: with the system locked
+              void broadcast_flags(eventflags_t flags)
+              { if(events) chEvtBroadcastFlagsI(events,flags); }
+
+              msg_t wait_tx(sysinterval_t timeout)
+              {
                 system_guard guard;
-                return tx_buffer.available();
+                return (!tx_buffer.is_full())? 
+                  MSG_OK: chThdEnqueueTimeoutS(&tx_waiting,timeout);
               }
       
-              // NOTE: only the 5, 6, 7, 8  or 9 lowest significant bits
-              // of data are send
-              bool set_tx_data(uint32_t data);
-      
               void flush()
               {
                 // wait until sending everything
@@ -1647,39 +3819,12 @@
                 { /*nothing */ }
               }
       
-              void flush_rx()
+              void set_rx_idle_timeout(uint32_t bits)
               {
                 system_guard guard;
-                rx_buffer.reset();
-              }
-      
-              tx_status_codes get_tx_status() { return tx_status; }
-      
-              uint32_t get_even_parity(uint32_t data,uint32_t bits)
-              {
-                uint32_t odd_parity=data&1;
-                for(uint32_t bit=1; bit<bits; bit++)
-                  odd_parity=odd_parity^((data>>bit)&1);
-                return odd_parity;
-              }
-      
-              void get_incoming_bit()
-              { rx_data |= (rx_bit<<rx_bit_counter); }
-      
-              void update_rx_data_buffer()
-              {
-                rx_data_status=(
-                  (rx_buffer.push(static_cast<uint32_t>(rx_data)))?
-                    rx_data_status_codes::DATA_AVAILABLE:
-                    rx_data_status_codes::DATA_LOST
-                );
-              }
-      
-              void set_outgoing_bit()
-              {
-                if((tx_data>>tx_bit_counter) & 1) 
-                  palSetPad(tx_port,tx_pin);
-                else palClearPad(tx_port,tx_pin);
+
+                rx_idle_bits=bits; rx_idle_quarters=(bits<<2);
+                rx_idle_counter=0;
               }
       
               gpio_port_t rx_port;
@@ -1688,44 +3833,31 @@
               gpio_port_t tx_port;
               uint32_t tx_pin;
       
-              double tc_tick;
-              double bit_time;
-              double frame_time;
               uint32_t bit_ticks;
               uint32_t bit_1st_half;
               uint32_t bit_1st_quarter;
+
+              // timer configuration selected for the bit rate, and the
+              // residual error of the bit time (in ppm)
+              GPTConfig gpt_config;
+              int32_t bit_error_ppm;
       
               // serial protocol
               uint32_t bit_rate;
-              data_bit_codes data_bits;
-              parity_codes parity;
-              stop_bit_codes stop_bits;
-              uint32_t rx_frame_bits;
-              uint32_t tx_frame_bits;
-              uint32_t parity_bit_pos;
-              uint32_t first_stop_bit_pos;
-              uint32_t data_mask;
-      
-              // rx data
-              circular_fifo<uint32_t,RX_BUFFER_LENGTH> rx_buffer;
-              volatile uint32_t rx_data;
-              volatile uint32_t rx_bit_counter;
-              volatile uint32_t rx_bit;
-              volatile rx_status_codes rx_status;
-              volatile uint32_t rx_data_status;
-              volatile uint32_t rx_interrupt_counter;
-      
-              // tx data
-              fifo<uint32_t,TX_BUFFER_LENGTH> tx_buffer;
-              volatile uint32_t tx_data;
-              volatile uint32_t tx_bit_counter;
-              volatile tx_status_codes tx_status;
-              volatile uint32_t tx_interrupt_counter;
+
+              // threads waiting for data received or for room on the
+              // TX buffer
+              threads_queue_t rx_waiting;
+              threads_queue_t tx_waiting;
+
+              // event source of the object configured (if any)
+              event_source_t* events;
             };
         
             static _uart_ctx_ _ctx_;
       
             mode_codes _mode_;
+            _channel_t _channel_;
         };
 
         template<
@@ -1738,7 +3870,7 @@
           TX_BUFFER_LENGTH
         >::_gpt_config_=
         {
-          10000000, /* timer clock (Hz).*/ 
+          10000000, /* default timer clock (Hz).*/ 
           uart<
             TIMER,
             RX_BUFFER_LENGTH,
@@ -1748,6 +3880,29 @@
           0
         };
 
+        // NOTE: the methods in the order of ChibiOS 19.1 BaseChannelVMT
+        template<
+          GPTDriver* TIMER,
+          size_t RX_BUFFER_LENGTH,
+          size_t TX_BUFFER_LENGTH
+        > const BaseChannelVMT uart<
+          TIMER,
+          RX_BUFFER_LENGTH,
+          TX_BUFFER_LENGTH
+        >::_channel_vmt_=
+        {
+          0, /* instance offset */
+          uart<TIMER,RX_BUFFER_LENGTH,TX_BUFFER_LENGTH>::_channel_write_,
+          uart<TIMER,RX_BUFFER_LENGTH,TX_BUFFER_LENGTH>::_channel_read_,
+          uart<TIMER,RX_BUFFER_LENGTH,TX_BUFFER_LENGTH>::_channel_put_,
+          uart<TIMER,RX_BUFFER_LENGTH,TX_BUFFER_LENGTH>::_channel_get_,
+          uart<TIMER,RX_BUFFER_LENGTH,TX_BUFFER_LENGTH>::_channel_putt_,
+          uart<TIMER,RX_BUFFER_LENGTH,TX_BUFFER_LENGTH>::_channel_gett_,
+          uart<TIMER,RX_BUFFER_LENGTH,TX_BUFFER_LENGTH>::_channel_writet_,
+          uart<TIMER,RX_BUFFER_LENGTH,TX_BUFFER_LENGTH>::_channel_readt_,
+          uart<TIMER,RX_BUFFER_LENGTH,TX_BUFFER_LENGTH>::_channel_ctl_
+        };
+
         template<
           GPTDriver* TIMER,
           size_t RX_BUFFER_LENGTH,
@@ -1782,52 +3937,22 @@
           ) return return_codes::BAD_BIT_RATE_ERROR;
       
           bit_rate=the_bit_rate;
-          
-          tc_tick=double(1)/double(_gpt_config_.frequency);
-          bit_time=double(1)/double(bit_rate);
-        
-          bit_1st_quarter=static_cast<uint32_t>(bit_time/(4*tc_tick));
+
+          // NOTE: the driver is started with the default configuration
+          // for knowing the timer input clock
+          gptStart(TIMER,&_gpt_config_);
+          if(!select_timer_frequency(TIMER->clock)) 
+            return return_codes::BAD_BIT_RATE_ERROR;
           bit_1st_half=(bit_1st_quarter<<1);
           bit_ticks=(bit_1st_half<<1);
       
-          data_bits=the_data_bits; parity=the_parity; stop_bits=the_stop_bits;
-      
-          // reception frame length in bits
-          rx_frame_bits=1 + // the start bit
-            static_cast<uint32_t>(data_bits) + // the data bits
-            ((parity!=parity_codes::NO_PARITY)? 1: 0) + // the parity?
-            1; // for reception we ONLY consider one stop bit
-      
-          // transmission frame length in bits
-          tx_frame_bits=rx_frame_bits;
-          if(stop_bits==stop_bit_codes::TWO_STOP_BITS) 
-          {
-            // for transmission we DO consider also the second stop bit
-            tx_frame_bits++; 
-          }
-      
-          frame_time=tx_frame_bits*bit_time;
-      
-          parity_bit_pos=1 + // the start bit
-            static_cast<uint32_t>(data_bits); // the data bits
-      
-          first_stop_bit_pos=parity_bit_pos +
-            ((parity!=parity_codes::NO_PARITY)? 1: 0); // the parity?
-      
-          data_mask=(1<<static_cast<uint32_t>(data_bits))-1;
+          format.set(the_data_bits,the_parity,the_stop_bits);
+          reset_engine();
       
           rx_port=the_rx_port; rx_pin=the_rx_pin;
-          rx_status=rx_status_codes::LISTENING;
-          rx_data_status=rx_data_status_codes::NO_DATA_AVAILABLE;
-          rx_buffer.reset();
-          rx_interrupt_counter=0;
-      
           tx_port=the_tx_port; tx_pin=the_tx_pin;
-          tx_status=tx_status_codes::IDLE;
-          tx_buffer.reset();
-          tx_interrupt_counter=0;
 
-          gptStart(TIMER,&_gpt_config_);
+          gptStart(TIMER,&gpt_config);
       
           return return_codes::EVERYTHING_OK;
         }
@@ -1836,230 +3961,189 @@
           GPTDriver* TIMER,
           size_t RX_BUFFER_LENGTH,
           size_t TX_BUFFER_LENGTH
-        > void uart<
+        > bool uart<
           TIMER,
           RX_BUFFER_LENGTH,
           TX_BUFFER_LENGTH
-        >::_uart_ctx_::tc_interrupt()
+        >::_uart_ctx_::select_timer_frequency(
+          uint32_t clock
+        )
         {
-          // rx code
-          if(rx_status==rx_status_codes::RECEIVING)
-          {
-            if(rx_interrupt_counter==1)
-            {
-              get_incoming_bit(); 
-              rx_bit_counter++;
-              if(rx_bit_counter==rx_frame_bits)
-              {
-                if(stop_bits==stop_bit_codes::TWO_STOP_BITS)
-                  get_incoming_bit();
-      
-                if(tx_status==tx_status_codes::IDLE) 
-                { interrupt_guard guard; gptStopTimerI(TIMER); }
-      
-                update_rx_data_buffer();
-      
-                rx_status=rx_status_codes::LISTENING;
-              }
-            }
-            rx_interrupt_counter=(rx_interrupt_counter+1)&0x3;
-          }
-      
-          // tx code
-          if(tx_status==tx_status_codes::SENDING)
+          // NOTE: the GPT interrupts each quarter of bit, so the 
+          // fastest timer frequency whose quarter of bit fits on the 
+          // timer is preferred, and from it some slower ones are tried 
+          // (only exact divisors of the clock, as ChibiOS requires), 
+          // keeping the one with the lowest error of the rounded quarter
+          // (the one with the quarters alternating less between the 
+          // floor and the ceil), stopping if exact
+          uint64_t quarter_rate=static_cast<uint64_t>(bit_rate)<<2;
+          uint64_t max_ticks=quarter_rate*MAX_GPT_INTERVAL;
+          uint64_t prescaler=(clock+max_ticks-1)/max_ticks;
+          if(!prescaler) prescaler=1;
+
+          uint64_t best_prescaler=0, best_quarter=0;
+          uint64_t best_error=~static_cast<uint64_t>(0);
+          uint32_t candidates=0;
+
+          for(
+            ;
+            (prescaler<=MAX_GPT_PRESCALER) && 
+            (candidates<GPT_PRESCALER_CANDIDATES) && 
+            best_error;
+            prescaler++
+          )
           {
-            if(tx_interrupt_counter==0)
-            {
-              if(tx_bit_counter>=tx_frame_bits)
-              {
-                uint32_t data_to_send;
-                if(tx_buffer.pop(data_to_send)) 
-                { 
-                  tx_data=data_to_send; tx_bit_counter=0; 
-                  set_outgoing_bit(); tx_bit_counter++;
-                }
-                else
-                {
-                  if(rx_status==rx_status_codes::LISTENING) 
-                  { interrupt_guard guard; gptStopTimerI(TIMER); }
-      
-                  tx_status=tx_status_codes::IDLE;
-                }
-              }
-              else { set_outgoing_bit(); tx_bit_counter++; }
+            if(clock%prescaler) continue;
+
+            uint64_t divisor=prescaler*quarter_rate;
+            uint64_t quarter=(clock+(divisor>>1))/divisor;
+            if((quarter<2) || (quarter>MAX_GPT_INTERVAL)) continue;
+
+            candidates++;
+            uint64_t ticks=quarter*divisor;
+            uint64_t error=(ticks>clock)? ticks-clock: clock-ticks;
+            if(error<best_error)
+            { 
+              best_error=error; 
+              best_prescaler=prescaler; best_quarter=quarter; 
             }
-            tx_interrupt_counter=(tx_interrupt_counter+1)&0x3;
           }
+
+          if(!best_prescaler) return false;
+
+          gpt_config=_gpt_config_;
+          gpt_config.frequency=static_cast<uint32_t>(clock/best_prescaler);
+
+          bit_1st_quarter=static_cast<uint32_t>(best_quarter);
+
+          // NOTE: on average the quarters keep on the fixed point bit
+          // time, so only its rounding is left
+          register uint32_t fixed_bit_ticks=
+            get_fixed_bit_ticks(gpt_config.frequency,bit_rate);
+          set_oversampling_bit_ticks(fixed_bit_ticks);
+
+          int64_t fixed_clock=
+            static_cast<int64_t>(gpt_config.frequency)<<TICK_FRACTION_BITS;
+          bit_error_ppm=static_cast<int32_t>(
+            (
+              static_cast<int64_t>(fixed_bit_ticks)*bit_rate-fixed_clock
+            )*1000000/fixed_clock
+          );
+
+          return true;
         }
-        
+      
         template<
           GPTDriver* TIMER,
           size_t RX_BUFFER_LENGTH,
           size_t TX_BUFFER_LENGTH
-        > void uart<
+        > size_t uart<
           TIMER,
           RX_BUFFER_LENGTH,
           TX_BUFFER_LENGTH
-        >::_uart_ctx_::rx_interrupt()
+        >::_uart_ctx_::read(
+          uint8_t* data,
+          size_t length,
+          sysinterval_t timeout
+        )
         {
-          register uint32_t sampled_bit= 
-            (palReadPad(rx_port,rx_pin)==PAL_HIGH)? 1:0;
-      
-          switch(rx_status)
+          // NOTE: frames are read in chunks, and the erroneous data and
+          // the idle line marks are discarded
+          uint32_t statuses[RX_CHUNK_FRAMES];
+          size_t count=0;
+
+          while(count<length)
           {
-            case rx_status_codes::LISTENING:
-              if(!sampled_bit)
-              {
-                rx_status=rx_status_codes::RECEIVING;
-                rx_data=rx_bit_counter=rx_bit=0;
-                rx_interrupt_counter=0;
-                
-                if(tx_status==tx_status_codes::IDLE) 
-                { 
-                  {
-                    interrupt_guard guard;
-                    gptStartContinuousI(TIMER,bit_1st_quarter);
-                  }
-                  rx_interrupt_counter=1; }
-              } 
-              break;
-              
-            case rx_status_codes::RECEIVING:
-              rx_bit=sampled_bit;
-              break;
+            size_t chunk=length-count;
+            if(chunk>RX_CHUNK_FRAMES) chunk=RX_CHUNK_FRAMES;
+
+            size_t frames=get_rx_data(data+count,chunk,statuses);
+            if(!frames) 
+            { 
+              if(wait_rx(timeout)!=MSG_OK) break; 
+              continue; 
+            }
+
+            size_t valid=count;
+            for(size_t i=0; i<frames; i++)
+              if(data_available(statuses[i]) && !bad_status(statuses[i])) 
+                data[valid++]=data[count+i];
+            count=valid;
           }
+
+          return count;
         }
-      
+
         template<
           GPTDriver* TIMER,
           size_t RX_BUFFER_LENGTH,
           size_t TX_BUFFER_LENGTH
-        > uint32_t uart<
+        > size_t uart<
           TIMER,
           RX_BUFFER_LENGTH,
           TX_BUFFER_LENGTH
-        >::_uart_ctx_::get_rx_data(
-          uint32_t& data
+        >::_uart_ctx_::write(
+          const uint8_t* data,
+          size_t length,
+          sysinterval_t timeout
         )
         {
-          register uint32_t status;
-          register bool not_empty;
-          uint32_t data_received;
-          
-          {
-            system_guard guard;
-            
-            status=(not_empty=rx_buffer.pop(data_received))?
-              rx_data_status_codes::DATA_AVAILABLE:
-              rx_data_status_codes::NO_DATA_AVAILABLE;
-          }
-      
-          if(!not_empty) return status;
-          
-          // checking start bit
-          status=(data_received & 1)?
-            status|rx_data_status_codes::BAD_START_BIT:
-            status&(~rx_data_status_codes::BAD_START_BIT);
-      
-          // cheking parity
-          if(parity!=parity_codes::NO_PARITY)
+          size_t count=0;
+
+          // NOTE: as there is room for them, the frames are not 
+          // rejected by set_tx_data()
+          while((count<length) && (wait_tx(timeout)==MSG_OK))
           {
-            register uint32_t data_parity=get_even_parity(
-              (data_received>>1),
-              static_cast<uint32_t>(data_bits)
-            );
-      
-            if(parity==parity_codes::ODD_PARITY) 
-              data_parity=data_parity^1;
-      
-            register uint32_t received_parity=
-              (data_received>>parity_bit_pos) & 1;
-      
-            // verifying parity bit
-            status=(received_parity^data_parity)?
-                status|rx_data_status_codes::BAD_PARITY:
-                status&(~rx_data_status_codes::BAD_PARITY);
+            size_t room=static_cast<size_t>(tx_buffer.available());
+            if(room>length-count) room=length-count;
+
+            count+=set_tx_data(data+count,room);
           }
-      
-          // checking stop bit
-          // NOTE: we only verify the first stop bit
-          status=((data_received>>first_stop_bit_pos) & 1)?
-            status&(~rx_data_status_codes::BAD_STOP_BIT):
-            status|rx_data_status_codes::BAD_STOP_BIT;
-      
-          // NOTE: in case of error, we put the received raw data
-          // on the high 16 bits of status
-          if(bad_status(status)) status=status|(data_received<<16);
-      
-          data=(data_received>>1)&data_mask;
-      
-          return status;
+
+          return count;
         }
-      
+
         template<
           GPTDriver* TIMER,
           size_t RX_BUFFER_LENGTH,
           size_t TX_BUFFER_LENGTH
-        > bool uart<
+        > msg_t uart<
           TIMER,
           RX_BUFFER_LENGTH,
           TX_BUFFER_LENGTH
-        >::_uart_ctx_::set_tx_data(
-          uint32_t data
+        >::_uart_ctx_::get(
+          sysinterval_t timeout
         )
         {
-          // setting the data to send
-          uint32_t data_to_send=data&data_mask;
-         
-          // setting the parity bit
-          if(parity!=parity_codes::NO_PARITY)
+          uint8_t data;
+          msg_t msg=MSG_OK;
+
+          while(msg==MSG_OK)
           {
-            register uint32_t data_parity=get_even_parity(
-              data_to_send,
-              static_cast<uint32_t>(data_bits)
-            );
-      
-            if(parity==parity_codes::ODD_PARITY) 
-              data_parity=data_parity^1;
-      
-            data_to_send=
-              (data_to_send<<1)|(data_parity<<parity_bit_pos);
+            if(read(&data,1,TIME_IMMEDIATE)) return data;
+            msg=wait_rx(timeout);
           }
-          else data_to_send=(data_to_send<<1);
-      
-          // setting the stop bits
-          if(stop_bits==stop_bit_codes::ONE_STOP_BIT)
-            data_to_send=data_to_send|(1<<first_stop_bit_pos);
-          else
-            data_to_send=data_to_send|(0x3<<first_stop_bit_pos);
-      
-	        rx_status_codes rx_status_tmp; 
-	        tx_status_codes tx_status_tmp;
-	        {
-            system_guard guard;
-            
-            if(!tx_buffer.push(data_to_send))  
-              return false; // tx buffer full
-            
-            if(tx_status==tx_status_codes::IDLE)
-            {
-              tx_buffer.pop(data_to_send); 
-              tx_data=data_to_send; tx_bit_counter=0; 
-              tx_interrupt_counter=0;
-            }
 
-	          rx_status_tmp=rx_status;
-	          tx_status_tmp=tx_status;
+          return msg;
+        }
 
-            tx_status=tx_status_codes::SENDING;
-	        }
+        template<
+          GPTDriver* TIMER,
+          size_t RX_BUFFER_LENGTH,
+          size_t TX_BUFFER_LENGTH
+        > msg_t uart<
+          TIMER,
+          RX_BUFFER_LENGTH,
+          TX_BUFFER_LENGTH
+        >::_uart_ctx_::put(
+          uint8_t data,
+          sysinterval_t timeout
+        )
+        {
+          msg_t msg=wait_tx(timeout);
+          if(msg==MSG_OK) set_tx_data(data);
 
-          if(
-            (rx_status_tmp==rx_status_codes::LISTENING)
-            && (tx_status_tmp==tx_status_codes::IDLE) 
-          ) gptStartContinuous(TIMER,bit_1st_quarter);
-      
-          return true;
+          return msg;
         }
 
       } // namespace chibios